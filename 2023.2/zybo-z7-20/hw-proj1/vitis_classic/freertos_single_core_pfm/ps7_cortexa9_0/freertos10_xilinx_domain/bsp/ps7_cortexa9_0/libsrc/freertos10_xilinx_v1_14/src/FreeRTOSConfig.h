@@ -108,15 +108,19 @@
 
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 0
 
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
 
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define configRUN_TIME_STATS_GLOBAL_TIMER 1
 
-#define portGET_RUN_TIME_COUNTER_VALUE()
+#define configRUN_TIME_COUNTER_TYPE uint64_t
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vPortConfigureRunTimeStatsTimer()
+
+#define portGET_RUN_TIME_COUNTER_VALUE() ullPortGetRunTimeCounterValue()
 
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
 
-#define configUSE_TICKLESS_IDLE	0
+#define configUSE_TICKLESS_IDLE	1
 #define configTASK_RETURN_ADDRESS    prvTaskExitError
 #define INCLUDE_vTaskPrioritySet             1
 #define INCLUDE_uxTaskPriorityGet            1
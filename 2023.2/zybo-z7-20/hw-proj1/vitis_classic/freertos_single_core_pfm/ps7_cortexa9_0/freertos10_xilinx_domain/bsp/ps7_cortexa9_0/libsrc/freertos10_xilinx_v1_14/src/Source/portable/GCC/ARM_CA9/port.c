@@ -224,7 +224,7 @@ volatile uint32_t ulPortInterruptNesting = 0UL;
  * Global counter used for calculation of run time statistics of tasks.
  * Defined only when the relevant option is turned on
  */
-#if (configGENERATE_RUN_TIME_STATS==1)
+#if portRUN_TIME_STATS_ON_TICK
 volatile uint32_t ulHighFrequencyTimerTicks;
 #endif
 
@@ -582,7 +582,7 @@ void FreeRTOS_Tick_Handler( void )
 	 * For handling generation of run time stats, it increments a pre-defined counter every time the
 	 * interrupt handler executes.
 	 */
-#if (configGENERATE_RUN_TIME_STATS == 1)
+#if portRUN_TIME_STATS_ON_TICK
 	ulHighFrequencyTimerTicks++;
 	if (!(ulHighFrequencyTimerTicks % 10))
 #endif
@@ -704,7 +704,7 @@ void vApplicationFPUSafeIRQHandler( uint32_t ulICCIAR )
 	configASSERT( ( volatile void * ) NULL );
 }
 
-#if( configGENERATE_RUN_TIME_STATS == 1 )
+#if portRUN_TIME_STATS_ON_TICK
 /*
  * For Xilinx implementation this is a dummy function that does a redundant operation
  * of zeroing out the global counter.
@@ -252,4 +252,23 @@ number of bits implemented by the interrupt controller. */
 #define portICCRPR_RUNNING_PRIORITY_REGISTER 				( *( ( const volatile uint32_t * ) ( portINTERRUPT_CONTROLLER_CPU_INTERFACE_ADDRESS + portICCRPR_RUNNING_PRIORITY_OFFSET ) ) )
 
 #define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+
+/* Run time stats counter.  configRUN_TIME_STATS_GLOBAL_TIMER = 1: the 64-bit
+global timer (portZynq7000.c), one count per CPU_3x2x clock cycle.  0: the
+Xilinx counter of tick interrupts, with the tick timer run 10 times faster. */
+#ifndef configRUN_TIME_STATS_GLOBAL_TIMER
+	#define configRUN_TIME_STATS_GLOBAL_TIMER	0
+#endif
+#define portRUN_TIME_STATS_ON_TICK	( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configRUN_TIME_STATS_GLOBAL_TIMER == 0 ) )
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configRUN_TIME_STATS_GLOBAL_TIMER == 1 )
+	void vPortConfigureRunTimeStatsTimer( void );
+	uint64_t ullPortGetRunTimeCounterValue( void );
+#endif
+
+/* Tickless idle (portZynq7000.c). */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
 #endif /* PORTMACRO_H */
@@ -39,9 +39,19 @@
 #else
 #include "xiltimer.h"
 #endif
+#include "xtime_l.h"
 
 #define XSCUTIMER_CLOCK_HZ ( XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2UL )
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	#ifdef XPAR_XILTIMER_ENABLED
+		#error Tickless idle is only implemented for the SCU private timer tick
+	#endif
+	#if portRUN_TIME_STATS_ON_TICK
+		#error Tickless idle cannot be used with the tick-based (tick rate x 10) run time stats
+	#endif
+#endif
+
 /*
  * Some FreeRTOSConfig.h settings require the application writer to provide the
  * implementation of a callback function that has a specific name, and a linker
@@ -74,6 +84,23 @@ void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer,
 #ifndef XPAR_XILTIMER_ENABLED
 static XScuTimer xTimer;
 #endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/* The SCU private timer and the global timer (xtime_l.c) both count the
+CPU_3x2x clock, so tick boundaries are kept as global timer times: tick
+xTickOriginCount started at xTickOrigin, and tick n starts
+( n - xTickOriginCount ) timer periods later.  The tick count is corrected
+from the global timer after a sleep, and the private timer is set to the next
+boundary, so the tick does not drift however often the sleep is cut short by
+other interrupts. */
+static uint32_t ulTimerCountsForOneTick = 0;
+static TickType_t xMaximumPossibleSuppressedTicks = 0;
+static XTime xTickOrigin = 0;
+static TickType_t xTickOriginCount = 0;
+
+/* Tick interrupts handled (counted in FreeRTOS_ClearTickInterrupt()). */
+static volatile uint32_t ulTickInterruptCount = 0;
+#endif
 XScuGic xInterruptController; 	/* Interrupt controller instance */
 
 /*-----------------------------------------------------------*/
@@ -123,7 +150,13 @@ const uint8_t ucRisingEdge = 3;
 	 * FreeRTOS ticks. In case user decides to generate run time stats the timer time out interval is changed
 	 * as "configured tick rate * 10". The multiplying factor of 10 is hard coded for Xilinx FreeRTOS ports.
 	 */
-#if (configGENERATE_RUN_TIME_STATS == 1)
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	/* The timer period is the load value + 1, which has to be exact for the
+	tick boundaries to stay on the global timer. */
+	ulTimerCountsForOneTick = XSCUTIMER_CLOCK_HZ / configTICK_RATE_HZ;
+	xMaximumPossibleSuppressedTicks = ( TickType_t ) ( ( 0xFFFFFFFFUL / ulTimerCountsForOneTick ) - 1UL );
+	XScuTimer_LoadTimer( &xTimer, ulTimerCountsForOneTick - 1UL );
+#elif portRUN_TIME_STATS_ON_TICK
 	XScuTimer_LoadTimer( &xTimer, XSCUTIMER_CLOCK_HZ / (configTICK_RATE_HZ * 10) );
 #else
 	XScuTimer_LoadTimer( &xTimer, XSCUTIMER_CLOCK_HZ / configTICK_RATE_HZ );
@@ -132,6 +165,10 @@ const uint8_t ucRisingEdge = 3;
 	/* Start the timer counter and then wait for it to timeout a number of
 	times. */
 	XScuTimer_Start( &xTimer );
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	XTime_GetTime( &xTickOrigin );
+	xTickOriginCount = 0;
+#endif
 
 	/* Enable the interrupt for the xTimer in the interrupt controller. */
 	XScuGic_Enable( &xInterruptController, XPAR_SCUTIMER_INTR );
@@ -145,7 +182,125 @@ const uint8_t ucRisingEdge = 3;
 void FreeRTOS_ClearTickInterrupt( void )
 {
 	XScuTimer_ClearInterruptStatus( &xTimer );
+#if ( configUSE_TICKLESS_IDLE == 1 )
+	ulTickInterruptCount++;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/*
+ * Called from the idle task, with the scheduler suspended, when no task is due
+ * to run for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks.  The private
+ * timer is set to fire at the start of the tick in which the next task is due,
+ * and the core waits in WFI.  Any interrupt (UART, TTC, ...) ends the sleep
+ * early; on the way out the tick count is stepped on by the number of tick
+ * periods that passed, worked out from the global timer, and the private timer
+ * is set to the next tick boundary.
+ */
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+XTime xNow, xWakeTime;
+TickType_t xEntryTickCount, xCountedTicks, xTicksNow, xTicksToStep, xStepLimit, xDroppedTicks;
+TickType_t xModifiableIdleTime;
+uint32_t ulEntryTickInterrupts, ulPendedTicks;
+
+	if( xExpectedIdleTime > xMaximumPossibleSuppressedTicks )
+	{
+		xExpectedIdleTime = xMaximumPossibleSuppressedTicks;
+	}
+
+	/* Mask IRQ in the CPU only.  A pending interrupt still ends WFI (masking
+	it with the GIC priority mask would not), but its handler only runs once
+	interrupts are enabled again below. */
+	__asm volatile (	"cpsid i	\n"
+						"dsb		\n"
+						"isb		\n" ::: "memory" );
+
+	xEntryTickCount = xTaskGetTickCount();
+	ulEntryTickInterrupts = ulTickInterruptCount;
+	xWakeTime = xTickOrigin + ( ( XTime ) ( TickType_t ) ( xEntryTickCount + xExpectedIdleTime - xTickOriginCount ) * ulTimerCountsForOneTick );
+	XTime_GetTime( &xNow );
+
+	/* Do not sleep if a task became ready, or a tick is pending, since the
+	idle task decided to call this function. */
+	if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) ||
+		( XScuTimer_IsExpired( &xTimer ) ) ||
+		( xWakeTime <= xNow ) )
+	{
+		__asm volatile ( "cpsie i" ::: "memory" );
+		return;
+	}
+
+	/* The timer keeps running: only its counter is moved on, and the load
+	value (one tick period) is used again after it fires. */
+	XScuTimer_SetCounterReg( xTimer.Config.BaseAddr, ( uint32_t ) ( xWakeTime - xNow ) );
+
+	/* Sleep until an interrupt.  configPRE_SLEEP_PROCESSING() can set the
+	time to 0 to skip the WFI, or put the board into a lower power state. */
+	xModifiableIdleTime = xExpectedIdleTime;
+	configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+	if( xModifiableIdleTime > 0 )
+	{
+		__asm volatile (	"dsb	\n"
+							"wfi	\n"
+							"isb	\n" ::: "memory" );
+	}
+	configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+	/* Let the interrupt that ended the sleep run now.  If it was the tick,
+	FreeRTOS_Tick_Handler() holds it pending, as the scheduler is suspended. */
+	__asm volatile (	"cpsie i	\n"
+						"dsb		\n"
+						"isb		\n" ::: "memory" );
+	__asm volatile (	"cpsid i	\n"
+						"dsb		\n"
+						"isb		\n" ::: "memory" );
+
+	/* Tick periods that have passed, against those already counted. */
+	XTime_GetTime( &xNow );
+	ulPendedTicks = ulTickInterruptCount - ulEntryTickInterrupts;
+	xCountedTicks = xEntryTickCount + ( TickType_t ) ulPendedTicks;
+	xTicksNow = xTickOriginCount + ( TickType_t ) ( ( xNow - xTickOrigin ) / ulTimerCountsForOneTick );
+
+	xTicksToStep = 0;
+	if( ( int32_t ) ( xTicksNow - xCountedTicks ) > 0 )
+	{
+		xTicksToStep = xTicksNow - xCountedTicks;
+	}
+
+	/* The tick count cannot be stepped past the time the next task is due;
+	that tick is left to the tick interrupt.  If interrupt handlers kept the
+	core busy for longer than that, the extra tick periods are dropped, as
+	they would have been with a late tick interrupt. */
+	xStepLimit = ( xExpectedIdleTime > ulPendedTicks ) ? ( xExpectedIdleTime - ( TickType_t ) ulPendedTicks ) : 0;
+	xDroppedTicks = 0;
+	if( xTicksToStep > xStepLimit )
+	{
+		xDroppedTicks = xTicksToStep - xStepLimit;
+		xTicksToStep = xStepLimit;
+	}
+
+	/* Move the origin up to the tick count the kernel will have, and set the
+	timer to the start of the next tick. */
+	xTickOrigin += ( XTime ) ( ( TickType_t ) ( xCountedTicks + xTicksToStep - xTickOriginCount ) + xDroppedTicks ) * ulTimerCountsForOneTick;
+	xTickOriginCount = xCountedTicks + xTicksToStep;
+
+	XTime_GetTime( &xNow );
+	xWakeTime = xTickOrigin + ulTimerCountsForOneTick;
+	XScuTimer_SetCounterReg( xTimer.Config.BaseAddr,
+							 ( xWakeTime > xNow ) ? ( uint32_t ) ( xWakeTime - xNow ) : 1UL );
+
+	__asm volatile ( "cpsie i" ::: "memory" );
+
+	/* vTaskStepTick() may enter a critical section, which enables IRQ in the
+	CPU, so it is called last. */
+	if( xTicksToStep > 0 )
+	{
+		vTaskStepTick( xTicksToStep );
+	}
 }
+#endif /* configUSE_TICKLESS_IDLE */
 #else
 void TimerCounterHandler(void *CallBackRef, u32 TmrCtrNumber)
 {
@@ -164,7 +319,7 @@ void FreeRTOS_SetupTickInterrupt( void )
 	 * FreeRTOS ticks. In case user decides to generate run time stats the timer time out interval is changed
 	 * as "configured tick rate * 10". The multiplying factor of 10 is hard coded for Xilinx FreeRTOS ports.
 	 */
-#if (configGENERATE_RUN_TIME_STATS == 1)
+#if portRUN_TIME_STATS_ON_TICK
 	/* XTimer_SetInterval() API expects delay in milli seconds
          * Convert the user provided tick rate to milli seconds.
          */
@@ -186,6 +341,29 @@ void FreeRTOS_ClearTickInterrupt( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 ) && ( configRUN_TIME_STATS_GLOBAL_TIMER == 1 )
+/* Run time stats on the 64-bit global timer, started by the boot code and
+never reloaded, so the tick rate is left alone and a task that runs for
+less than a tick is still accounted for, to one CPU_3x2x clock cycle
+(COUNTS_PER_SECOND). */
+static XTime xRunTimeStatsOrigin = 0;
+
+void vPortConfigureRunTimeStatsTimer( void )
+{
+	XTime_GetTime( &xRunTimeStatsOrigin );
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullPortGetRunTimeCounterValue( void )
+{
+XTime xNow;
+
+	XTime_GetTime( &xNow );
+	return ( uint64_t ) ( xNow - xRunTimeStatsOrigin );
+}
+/*-----------------------------------------------------------*/
+#endif
+
 void vApplicationIRQHandler( uint32_t ulICCIAR )
 {
 extern XScuGic_Config XScuGic_ConfigTable[];
@@ -0,0 +1,571 @@
+/******************************************************************************
+ * @Title		:	Command Handler Host Benchmark
+ * @Filename	:	cmd_bench.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	gcc (host)
+ * @Target		: 	Linux host
+ * @Platform	: 	Linux host
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+/* Runs the command handler (ulCmdHandlerProcess) on the host against the mock
+ * memory backend and reports ns/frame and frames/s for each scenario (single
+ * opcodes, frame formats, error paths and a frame mix).
+ *
+ *   cmd_bench                          print the results
+ *   cmd_bench --save FILE              also save them as a baseline
+ *   cmd_bench --check FILE [--tolerance PCT]
+ *                                      compare with a baseline; exit code 1 if
+ *                                      any scenario is more than PCT percent
+ *                                      (default 10) slower
+ *   cmd_bench --runs N                 timed runs per scenario (default 5);
+ *                                      the fastest run is reported
+ *
+ * Each frame is first executed once and its response checked, so a scenario
+ * that silently turns into an error path fails instead of looking fast. */
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmd_handler64B.h"
+#include "crc32.h"
+#include "task.h"
+
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+#define BENCH_MAX_FRAMES		8U			// Frames per scenario (cycled)
+#define BENCH_MAX_SCENARIOS		24U
+#define BENCH_MIN_RUN_NS		20000000ULL	// Each timed run lasts at least 20 ms
+#define BENCH_DEFAULT_RUNS		5U
+#define BENCH_DEFAULT_TOLERANCE	10.0
+
+#define BENCH_APP_CMD			0x00E0U		// Trivial application command
+
+/* Expected response */
+#define EXPECT_OK				0U
+#define EXPECT_CMD_ERROR		1U
+#define EXPECT_CRC_ERROR		2U
+
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+typedef struct {
+	uint8_t		buf[CMD_LONG_FRAME_MAX_SIZE];
+	uint32_t	len;
+} BenchFrame_s;
+
+typedef struct {
+	const char		*name;
+	uint32_t		n_frames;
+	uint32_t		expect;
+	BenchFrame_s	frames[BENCH_MAX_FRAMES];
+	double			ns_per_frame;
+} BenchScenario_s;
+
+
+
+/*****************************************************************************/
+/************************** Variable Declarations ****************************/
+/*****************************************************************************/
+
+volatile u32 MockMem[MOCK_MEM_WORDS];
+volatile TickType_t MockTickCount;
+
+static BenchScenario_s Scenarios[BENCH_MAX_SCENARIOS];
+static uint32_t ulScenarioCount = 0;
+
+static CmdHandlerCtx_s BenchCtx;
+static uint8_t ucTxBuffer[CMD_LONG_FRAME_MAX_SIZE];
+
+
+
+/*---------------------------------------------------------------------------*/
+/*--------------------------- FRAME CONSTRUCTION ----------------------------*/
+/*---------------------------------------------------------------------------*/
+
+/* 64-byte frame: cmd/sz, field1, then up to 14 data words. */
+static void vBuildFrame(BenchFrame_s *p_frame, uint16_t cmd, uint16_t sz,
+						uint32_t field1, const uint32_t *p_data, uint32_t n_data)
+{
+	uint32_t idx;
+
+	memset(p_frame->buf, 0, CMD_FRAME_SIZE);
+	vCmdStoreBE32(&p_frame->buf[0], ((uint32_t)cmd << 16) | sz);
+	vCmdStoreBE32(&p_frame->buf[4], field1);
+
+	for (idx = 0; idx < n_data; idx++)
+	{
+		vCmdStoreBE32(&p_frame->buf[8U + (4U * idx)], p_data[idx]);
+	}
+
+	if (cmd & CMD_CRC_FRAME)
+	{
+		vCmdStoreBE32(&p_frame->buf[CMD_FRAME_SIZE - CMD_CRC_SIZE],
+					  ulCrc32(p_frame->buf, CMD_FRAME_SIZE - CMD_CRC_SIZE));
+	}
+
+	p_frame->len = CMD_FRAME_SIZE;
+}
+
+
+/* Long frame: header, n_data data words, optional CRC, padding. */
+static void vBuildLongFrame(BenchFrame_s *p_frame, uint16_t cmd, uint16_t sz,
+							uint32_t field1, uint32_t n_data)
+{
+	uint32_t len = CMD_LONG_HDR_SIZE + (4U * n_data);
+	uint32_t crc_size = (cmd & CMD_CRC_FRAME) ? CMD_CRC_SIZE : 0U;
+	uint32_t idx;
+
+	p_frame->len = CMD_FRAME_WIRE_SIZE(len + crc_size);
+	memset(p_frame->buf, 0, p_frame->len);
+
+	vCmdStoreBE32(&p_frame->buf[0], ((uint32_t)(cmd | CMD_LONG_FRAME) << 16) | sz);
+	vCmdStoreBE32(&p_frame->buf[4], field1);
+	vCmdStoreBE32(&p_frame->buf[8], len);
+
+	for (idx = 0; idx < n_data; idx++)
+	{
+		vCmdStoreBE32(&p_frame->buf[CMD_LONG_HDR_SIZE + (4U * idx)], 0x5A000000U + idx);
+	}
+
+	if (crc_size != 0U)
+	{
+		vCmdStoreBE32(&p_frame->buf[len], ulCrc32(p_frame->buf, len));
+	}
+}
+
+
+/* BATCH frame of n READ_WORD/WRITE_WORD records. */
+static void vBuildBatchFrame(BenchFrame_s *p_frame, uint32_t n, uint8_t sub_cmd)
+{
+	uint32_t idx;
+	uint8_t *p_rec = &p_frame->buf[4];
+
+	memset(p_frame->buf, 0, CMD_FRAME_SIZE);
+	vCmdStoreBE32(&p_frame->buf[0], ((uint32_t)BATCH << 16) | n);
+
+	for (idx = 0; idx < n; idx++)
+	{
+		p_rec[0] = (uint8_t)idx;
+		p_rec[1] = sub_cmd;
+		vCmdStoreBE32(&p_rec[2], 0x1000U + (4U * idx));
+		vCmdStoreBE32(&p_rec[6], idx);
+		p_rec += CMD_BATCH_REQ_SIZE;
+	}
+
+	p_frame->len = CMD_FRAME_SIZE;
+}
+
+
+static BenchScenario_s *pxAddScenario(const char *name, uint32_t expect)
+{
+	BenchScenario_s *p_sc = &Scenarios[ulScenarioCount++];
+
+	p_sc->name = name;
+	p_sc->expect = expect;
+	p_sc->n_frames = 0;
+	return p_sc;
+}
+
+
+static void vBuildScenarios(void)
+{
+	static const uint32_t data[CMD_FRAME_FIELDS] = {
+		1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+	static const uint32_t wrap_len[1] = { 0xFFFFFFFCU };
+	BenchScenario_s *p_sc;
+
+	/* ----- 64-byte frames, one opcode each ----- */
+	p_sc = pxAddScenario("write_word", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_WORD, 0, 0x100, data, 1);
+
+	p_sc = pxAddScenario("read_word", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_WORD, 0, 0x100, NULL, 0);
+
+	p_sc = pxAddScenario("write_seq_14", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_SEQUENTIAL, 14, 0x200, data, 14);
+
+	p_sc = pxAddScenario("read_seq_16", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL, 16, 0x200, NULL, 0);
+
+	p_sc = pxAddScenario("batch_6_read", EXPECT_OK);
+	vBuildBatchFrame(&p_sc->frames[p_sc->n_frames++], 6, (uint8_t)READ_WORD);
+
+	p_sc = pxAddScenario("batch_6_write", EXPECT_OK);
+	vBuildBatchFrame(&p_sc->frames[p_sc->n_frames++], 6, (uint8_t)WRITE_WORD);
+
+	p_sc = pxAddScenario("app_cmd", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], BENCH_APP_CMD, 0, 0, NULL, 0);
+
+	/* ----- Register access ----- */
+	{
+		static const uint32_t rmw[2] = { 0xFFFF00FFU, 0x00005A00U };
+		static const uint32_t masked[2] = { 0x0000FF00U, 0x0000A500U };
+		static const uint32_t poll[4] = { 0x00000001U, 0x00000000U, 100U, 10U };
+
+		p_sc = pxAddScenario("read_modify_write", EXPECT_OK);
+		vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_MODIFY_WRITE, 0, 0x300, rmw, 2);
+
+		p_sc = pxAddScenario("masked_write", EXPECT_OK);
+		vBuildFrame(&p_sc->frames[p_sc->n_frames++], MASKED_WRITE, 0, 0x300, masked, 2);
+
+		/* Bit 0 of 0x400 is never set, so this matches on the first read. */
+		p_sc = pxAddScenario("poll_until_match", EXPECT_OK);
+		vBuildFrame(&p_sc->frames[p_sc->n_frames++], POLL_UNTIL, CMD_POLL_EQUAL, 0x400, poll, 4);
+	}
+
+	/* ----- Scatter-gather (unrelated registers) ----- */
+	{
+		static const uint32_t gather[14] = {
+			0x0000, 0x1004, 0x2008, 0x300C, 0x0010, 0x1014, 0x2018,
+			0x301C, 0x0020, 0x1024, 0x2028, 0x302C, 0x0030, 0x1034 };
+		static const uint32_t scatter[14] = {
+			0x0000, 1, 0x1004, 2, 0x2008, 3, 0x300C, 4, 0x0010, 5, 0x1014, 6, 0x2018, 7 };
+
+		/* The list starts at field1 */
+		p_sc = pxAddScenario("gather_read_14", EXPECT_OK);
+		vBuildFrame(&p_sc->frames[p_sc->n_frames++], GATHER_READ, 14, gather[0], &gather[1], 13);
+
+		p_sc = pxAddScenario("scatter_write_7", EXPECT_OK);
+		vBuildFrame(&p_sc->frames[p_sc->n_frames++], SCATTER_WRITE, 7, scatter[0], &scatter[1], 13);
+	}
+
+	/* ----- CRC trailer ----- */
+	p_sc = pxAddScenario("write_seq_13_crc", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_SEQUENTIAL | CMD_CRC_FRAME, 13, 0x200, data, 13);
+
+	p_sc = pxAddScenario("read_seq_15_crc", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL | CMD_CRC_FRAME, 15, 0x200, NULL, 0);
+
+	/* ----- Long frames (4 KB) ----- */
+	p_sc = pxAddScenario("long_write_1021", EXPECT_OK);
+	vBuildLongFrame(&p_sc->frames[p_sc->n_frames++], WRITE_SEQUENTIAL, 1021, 0x2000, 1021);
+
+	p_sc = pxAddScenario("long_read_1021", EXPECT_OK);
+	vBuildLongFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL, 1021, 0x2000, 0);
+
+	p_sc = pxAddScenario("long_read_1020_crc", EXPECT_OK);
+	vBuildLongFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL | CMD_CRC_FRAME, 1020, 0x2000, 0);
+
+	/* ----- Error paths ----- */
+	p_sc = pxAddScenario("unknown_cmd", EXPECT_CMD_ERROR);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], 0x00C1, 0, 0, NULL, 0);
+
+	p_sc = pxAddScenario("bad_crc", EXPECT_CRC_ERROR);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames], WRITE_SEQUENTIAL | CMD_CRC_FRAME, 13, 0x200, data, 13);
+	p_sc->frames[p_sc->n_frames++].buf[20] ^= 0x01U;
+
+	/* Long frame length that wraps to 0 when the CRC size is added. */
+	p_sc = pxAddScenario("long_len_wrap", EXPECT_CMD_ERROR);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL | CMD_LONG_FRAME | CMD_CRC_FRAME, 1, 0x2000, wrap_len, 1);
+
+	/* ----- Mix of 64-byte frames ----- */
+	p_sc = pxAddScenario("mix_legacy", EXPECT_OK);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_WORD, 0, 0x100, NULL, 0);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_WORD, 0, 0x104, data, 1);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_WORD, 0, 0x104, NULL, 0);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_SEQUENTIAL, 16, 0x200, NULL, 0);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_WORD, 0, 0x108, data, 1);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], READ_WORD, 0, 0x108, NULL, 0);
+	vBuildFrame(&p_sc->frames[p_sc->n_frames++], WRITE_SEQUENTIAL, 14, 0x200, data, 14);
+	vBuildBatchFrame(&p_sc->frames[p_sc->n_frames++], 6, (uint8_t)READ_WORD);
+}
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- BENCHMARK ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+static uint32_t cmdBenchApp(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	setResponseBytes(tx_data, p_frame->sz);
+	return 1U;
+}
+
+
+static uint64_t ullNowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/* Executes every frame of the scenario once and checks the response. */
+static int xCheckScenario(const BenchScenario_s *p_sc)
+{
+	uint32_t idx;
+	uint32_t tx_len;
+	uint32_t word;
+
+	for (idx = 0; idx < p_sc->n_frames; idx++)
+	{
+		tx_len = ulCmdHandlerProcess(&BenchCtx, (uint8_t *)p_sc->frames[idx].buf, p_sc->frames[idx].len,
+									 ucTxBuffer, sizeof(ucTxBuffer));
+
+		/* First data word of the response */
+		word = ulCmdLoadBE32(&ucTxBuffer[(p_sc->frames[idx].len > CMD_FRAME_SIZE) ? CMD_LONG_HDR_SIZE : 0U]);
+
+		if ( (tx_len == 0U) ||
+			 ((p_sc->expect == EXPECT_OK) && ((word == CMD_ERROR) || (word == CMD_CRC_ERROR))) ||
+			 ((p_sc->expect == EXPECT_CMD_ERROR) && (word != CMD_ERROR)) ||
+			 ((p_sc->expect == EXPECT_CRC_ERROR) && (word != CMD_CRC_ERROR)) )
+		{
+			fprintf(stderr, "%s: frame %u: unexpected response 0x%08X (%u bytes)\n",
+					p_sc->name, idx, word, tx_len);
+			return XST_FAILURE;
+		}
+	}
+
+	return XST_SUCCESS;
+}
+
+
+static double dRunScenario(const BenchScenario_s *p_sc, uint32_t runs)
+{
+	uint64_t iters = 1024U;
+	uint64_t start;
+	uint64_t elapsed;
+	uint64_t i;
+	uint32_t frame;
+	uint32_t run;
+	double best = 0.0;
+	double ns;
+
+	/* Find an iteration count that takes at least BENCH_MIN_RUN_NS */
+	for (;;)
+	{
+		start = ullNowNs();
+		for (i = 0, frame = 0; i < iters; i++)
+		{
+			ulCmdHandlerProcess(&BenchCtx, (uint8_t *)p_sc->frames[frame].buf, p_sc->frames[frame].len,
+								ucTxBuffer, sizeof(ucTxBuffer));
+			if (++frame == p_sc->n_frames) { frame = 0; }
+		}
+		elapsed = ullNowNs() - start;
+
+		if (elapsed >= BENCH_MIN_RUN_NS) { break; }
+		iters *= 2U;
+	}
+
+	/* Timed runs; the fastest is the least disturbed by the host OS */
+	for (run = 0; run < runs; run++)
+	{
+		start = ullNowNs();
+		for (i = 0, frame = 0; i < iters; i++)
+		{
+			ulCmdHandlerProcess(&BenchCtx, (uint8_t *)p_sc->frames[frame].buf, p_sc->frames[frame].len,
+								ucTxBuffer, sizeof(ucTxBuffer));
+			if (++frame == p_sc->n_frames) { frame = 0; }
+		}
+		elapsed = ullNowNs() - start;
+
+		ns = (double)elapsed / (double)iters;
+		if ((run == 0U) || (ns < best)) { best = ns; }
+	}
+
+	return best;
+}
+
+
+
+/*---------------------------------------------------------------------------*/
+/*-------------------------------- BASELINE ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+static int xSaveBaseline(const char *path)
+{
+	FILE *fp = fopen(path, "w");
+	uint32_t idx;
+
+	if (fp == NULL)
+	{
+		perror(path);
+		return XST_FAILURE;
+	}
+
+	fprintf(fp, "# cmd_bench baseline: scenario ns/frame\n");
+	for (idx = 0; idx < ulScenarioCount; idx++)
+	{
+		fprintf(fp, "%s %.3f\n", Scenarios[idx].name, Scenarios[idx].ns_per_frame);
+	}
+
+	fclose(fp);
+	printf("\nBaseline saved to %s\n", path);
+	return XST_SUCCESS;
+}
+
+
+static int xCheckBaseline(const char *path, double tolerance)
+{
+	FILE *fp = fopen(path, "r");
+	char line[256];
+	char name[128];
+	double base_ns;
+	uint32_t idx;
+	uint32_t regressions = 0;
+	uint32_t compared = 0;
+
+	if (fp == NULL)
+	{
+		perror(path);
+		return XST_FAILURE;
+	}
+
+	printf("\n%-22s %12s %12s %9s\n", "scenario", "base ns", "now ns", "change");
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		if ( (line[0] == '#') || (sscanf(line, "%127s %lf", name, &base_ns) != 2) )
+		{
+			continue;
+		}
+
+		for (idx = 0; idx < ulScenarioCount; idx++)
+		{
+			if (strcmp(name, Scenarios[idx].name) == 0) { break; }
+		}
+
+		if (idx == ulScenarioCount)
+		{
+			printf("%-22s %12.1f %12s %9s\n", name, base_ns, "-", "removed");
+			continue;
+		}
+
+		double change = 100.0 * (Scenarios[idx].ns_per_frame - base_ns) / base_ns;
+		int slow = (change > tolerance);
+
+		printf("%-22s %12.1f %12.1f %+8.1f%%%s\n", name, base_ns,
+			   Scenarios[idx].ns_per_frame, change, slow ? "  REGRESSION" : "");
+
+		regressions += (uint32_t)slow;
+		compared++;
+	}
+
+	fclose(fp);
+
+	printf("\n%u scenarios compared, %u slower than the baseline by more than %.1f%%\n",
+		   compared, regressions, tolerance);
+
+	return ((regressions == 0U) && (compared > 0U)) ? XST_SUCCESS : XST_FAILURE;
+}
+
+
+
+/*============================================*/
+/* ================= MAIN CODE ===============*/
+/*============================================*/
+
+static void vUsage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [--runs N] [--save FILE | --check FILE [--tolerance PCT]]\n", prog);
+}
+
+
+int main(int argc, char *argv[])
+{
+	const char *save_path = NULL;
+	const char *check_path = NULL;
+	double tolerance = BENCH_DEFAULT_TOLERANCE;
+	uint32_t runs = BENCH_DEFAULT_RUNS;
+	uint8_t negotiate[CMD_FRAME_SIZE];
+	uint8_t resp[CMD_FRAME_SIZE];
+	uint32_t idx;
+	int arg;
+
+	for (arg = 1; arg < argc; arg++)
+	{
+		if ((strcmp(argv[arg], "--save") == 0) && (arg + 1 < argc))				{ save_path = argv[++arg]; }
+		else if ((strcmp(argv[arg], "--check") == 0) && (arg + 1 < argc))		{ check_path = argv[++arg]; }
+		else if ((strcmp(argv[arg], "--tolerance") == 0) && (arg + 1 < argc))	{ tolerance = atof(argv[++arg]); }
+		else if ((strcmp(argv[arg], "--runs") == 0) && (arg + 1 < argc))		{ runs = (uint32_t)atoi(argv[++arg]); }
+		else { vUsage(argv[0]); return 2; }
+	}
+
+	if ((runs == 0U) || (save_path && check_path))
+	{
+		vUsage(argv[0]);
+		return 2;
+	}
+
+
+	/* ----- Command handler set-up, as on the target ----- */
+	vCmdHandlerInit();
+	vCmdHandlerCtxInit(&BenchCtx);
+	xCmdHandlerRegister(BENCH_APP_CMD, 0U, 0xFFFFU, CMD_FLAG_BATCHABLE, cmdBenchApp);
+
+	memset(negotiate, 0, sizeof(negotiate));
+	vCmdStoreBE32(&negotiate[0], (uint32_t)NEGOTIATE_FRAME << 16);
+	vCmdStoreBE32(&negotiate[4], CMD_LONG_FRAME_MAX_SIZE);
+	ulCmdHandlerProcess(&BenchCtx, negotiate, sizeof(negotiate), resp, sizeof(resp));
+
+	vBuildScenarios();
+
+
+	/* ----- Run ----- */
+	printf("%-22s %8s %12s %14s\n", "scenario", "rx bytes", "ns/frame", "frames/s");
+
+	for (idx = 0; idx < ulScenarioCount; idx++)
+	{
+		BenchScenario_s *p_sc = &Scenarios[idx];
+
+		if (xCheckScenario(p_sc) != XST_SUCCESS)
+		{
+			return 1;
+		}
+
+		p_sc->ns_per_frame = dRunScenario(p_sc, runs);
+
+		printf("%-22s %8u %12.1f %14.0f\n", p_sc->name, p_sc->frames[0].len,
+			   p_sc->ns_per_frame, 1.0e9 / p_sc->ns_per_frame);
+	}
+
+
+	/* ----- Baseline ----- */
+	if (save_path != NULL)
+	{
+		return (xSaveBaseline(save_path) == XST_SUCCESS) ? 0 : 1;
+	}
+
+	if (check_path != NULL)
+	{
+		return (xCheckBaseline(check_path, tolerance) == XST_SUCCESS) ? 0 : 1;
+	}
+
+	return 0;
+}
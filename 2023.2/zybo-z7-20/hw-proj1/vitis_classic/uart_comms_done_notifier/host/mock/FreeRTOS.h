@@ -0,0 +1,15 @@
+/* Host build: stand-in for FreeRTOS.h, with just what the command handler
+ * uses. The tick rate matches the target's FreeRTOSConfig.h. */
+
+#ifndef MOCK_FREERTOS_H_
+#define MOCK_FREERTOS_H_
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ		(100U)
+#define portTICK_PERIOD_MS		((TickType_t)1000U / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs)	((TickType_t)(((TickType_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+#endif /* MOCK_FREERTOS_H_ */
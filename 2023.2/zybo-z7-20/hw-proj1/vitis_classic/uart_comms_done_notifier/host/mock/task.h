@@ -0,0 +1,26 @@
+/* Host build: stand-in for task.h.
+ *
+ * There is no scheduler: critical sections do nothing and vTaskDelay() just
+ * advances the mock tick count, so POLL_UNTIL timeouts run instantly. */
+
+#ifndef MOCK_TASK_H_
+#define MOCK_TASK_H_
+
+#include "FreeRTOS.h"
+
+extern volatile TickType_t MockTickCount;
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+static inline TickType_t xTaskGetTickCount(void)
+{
+	return MockTickCount;
+}
+
+static inline void vTaskDelay(TickType_t xTicksToDelay)
+{
+	MockTickCount += xTicksToDelay;
+}
+
+#endif /* MOCK_TASK_H_ */
@@ -0,0 +1,26 @@
+/* Host build: stand-in for the BSP's xil_io.h.
+ *
+ * Register/memory accesses go to a 64 KB array; the address wraps, so any
+ * 32-bit address is valid. The accesses are volatile, like the real ones, so
+ * the compiler cannot optimise them away in the benchmark. */
+
+#ifndef MOCK_XIL_IO_H_
+#define MOCK_XIL_IO_H_
+
+#include "xil_types.h"
+
+#define MOCK_MEM_WORDS		(16384U)
+
+extern volatile u32 MockMem[MOCK_MEM_WORDS];
+
+static inline u32 Xil_In32(UINTPTR Addr)
+{
+	return MockMem[(Addr >> 2) & (MOCK_MEM_WORDS - 1U)];
+}
+
+static inline void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+	MockMem[(Addr >> 2) & (MOCK_MEM_WORDS - 1U)] = Value;
+}
+
+#endif /* MOCK_XIL_IO_H_ */
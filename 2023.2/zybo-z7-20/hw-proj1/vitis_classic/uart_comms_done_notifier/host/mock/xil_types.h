@@ -0,0 +1,15 @@
+/* Host build: stand-in for the BSP's xil_types.h. */
+
+#ifndef MOCK_XIL_TYPES_H_
+#define MOCK_XIL_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t		u8;
+typedef uint16_t	u16;
+typedef uint32_t	u32;
+typedef uintptr_t	UINTPTR;
+typedef intptr_t	INTPTR;
+
+#endif /* MOCK_XIL_TYPES_H_ */
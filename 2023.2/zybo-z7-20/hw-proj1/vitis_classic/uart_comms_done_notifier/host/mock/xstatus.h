@@ -0,0 +1,10 @@
+/* Host build: stand-in for the BSP's xstatus.h. */
+
+#ifndef MOCK_XSTATUS_H_
+#define MOCK_XSTATUS_H_
+
+#define XST_SUCCESS				0L
+#define XST_FAILURE				1L
+#define XST_INVALID_PARAM		15L
+
+#endif /* MOCK_XSTATUS_H_ */
@@ -0,0 +1,449 @@
+/******************************************************************************
+ * @Title		:	PS7 DMA Controller Interface
+ * @Filename	:	ps7_dma_if.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "ps7_dma_if.h"
+
+#include "task.h"
+#include "semphr.h"
+#include "xil_cache.h"
+
+
+
+
+/*****************************************************************************/
+/************************** Variable Declarations ****************************/
+/*****************************************************************************/
+
+/* Instance registered by xDmaPsInit(). */
+static XDmaPs *p_DmaInst = NULL;
+
+/* Command for the transfer in progress (the driver keeps a pointer to it). */
+static XDmaPs_Cmd DmaCmd;
+
+/* Source word for fills, on its own cache line. */
+static u32 ulDmaFillPattern __attribute__((aligned(32)));
+
+/* Serialises the transfers of different tasks (one channel is used). */
+static SemaphoreHandle_t xDmaMutex = NULL;
+
+/* Given by the DMA handlers when the transfer ends, and the result they set.
+ * A semaphore rather than a task notification, because the calling task (e.g.
+ * the command handler Rx task) may use its notification for other events. */
+static SemaphoreHandle_t xDmaDoneSemaphore = NULL;
+static volatile int xDmaResult = XST_FAILURE;
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+static int xDmaPsTransfer(UINTPTR dst, UINTPTR src, u32 len, unsigned int src_inc);
+static void vDmaDoneHandler(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef);
+static void vDmaFaultHandler(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef);
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/*****************************************************************************
+ * Function: xDmaPsInit()
+ *//**
+ *
+ * @brief		Configures the PS7 DMA controller (PL330) for use.
+ *
+ *
+ * @details		Starts by doing device look-up, configuration and self-test.
+ * 				Then configures the DMA controller for this project.
+ *
+ * 				The initialisation steps are:
+ * 				(1) DEVICE LOOK-UP => Calls function "XDmaPs_LookupConfig"
+ * 				(2) DRIVER INIT => Calls function "XDmaPs_CfgInitialize"
+ * 				(3) SELF TEST => Calls function "XDmaPs_SelfTest"
+ * 				(4) SPECIFIC CONFIG => Sets the done/fault handlers
+ * 				(5) Interrupt configuration.
+ *
+ * 				If any of the first three states results in XST_FAILURE, the
+ * 				initialisation will stop and the XST_FAILURE code will be
+ * 				returned to the calling code. If initialisation completes with
+ * 				no failures, then XST_SUCCESS is returned.
+ *
+ * @return		Integer indicating result of configuration attempt.
+ * 				0 = SUCCESS, 1 = FAILURE
+ *
+ * @note		p_DmaPsInst and  p_xInterruptController must be passed by
+ * 				reference from calling code.
+ *
+******************************************************************************/
+
+int xDmaPsInit(XDmaPs* p_DmaPsInst, XScuGic* p_xInterruptController)
+{
+
+	int status;
+
+	/* Pointer to XDmaPs_Config is required for later functions. */
+	XDmaPs_Config *p_DmaPsCfg = NULL;
+
+
+	/* === START CONFIGURATION SEQUENCE ===  */
+
+	/* ---------------------------------------------------------------------
+	 * ------------ STEP 1: DEVICE LOOK-UP ------------
+	 * -------------------------------------------------------------------- */
+	p_DmaPsCfg = XDmaPs_LookupConfig(PS7_DMA_DEVICE_ID);
+	if (p_DmaPsCfg == NULL)
+	{
+		status = XST_FAILURE;
+		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	 * ------------ STEP 2: DRIVER INITIALISATION ------------
+	 * -------------------------------------------------------------------- */
+	status = XDmaPs_CfgInitialize(p_DmaPsInst, p_DmaPsCfg, p_DmaPsCfg->BaseAddress);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 3: SELF TEST ------------
+	* -------------------------------------------------------------------- */
+	status = XDmaPs_SelfTest(p_DmaPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 4: PROJECT-SPECIFIC CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+	/* Both handlers are called from the driver's ISRs and wake the task
+	 * waiting in xDmaPsTransfer(). */
+	xDmaMutex = xSemaphoreCreateMutex();
+	xDmaDoneSemaphore = xSemaphoreCreateBinary();
+	if ( (xDmaMutex == NULL) || (xDmaDoneSemaphore == NULL) )
+	{
+		return XST_FAILURE;
+	}
+
+	status = XDmaPs_SetDoneHandler(p_DmaPsInst, PS7_DMA_CHANNEL, vDmaDoneHandler, NULL);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+	status = XDmaPs_SetFaultHandler(p_DmaPsInst, vDmaFaultHandler, NULL);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 5: INTERRUPT CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+	/* Connect the driver's handlers for the fault and channel-done interrupts */
+	status = XScuGic_Connect(p_xInterruptController, DMA_FAULT_INTR_ID,
+				  (Xil_ExceptionHandler) XDmaPs_FaultISR,
+				  (void *) p_DmaPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	status = XScuGic_Connect(p_xInterruptController, DMA_DONE_INTR_ID,
+				  (Xil_ExceptionHandler) XDmaPs_DoneISR_0,
+				  (void *) p_DmaPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+
+	/* Set priority and trigger type */
+	XScuGic_SetPriorityTriggerType(p_xInterruptController, DMA_FAULT_INTR_ID,
+									DMA_INTR_PRI, DMA_INTR_TRIG);
+	XScuGic_SetPriorityTriggerType(p_xInterruptController, DMA_DONE_INTR_ID,
+									DMA_INTR_PRI, DMA_INTR_TRIG);
+
+
+	/* Enable the interrupts for the DMA */
+	XScuGic_Enable(p_xInterruptController, DMA_FAULT_INTR_ID);
+	XScuGic_Enable(p_xInterruptController, DMA_DONE_INTR_ID);
+
+
+	p_DmaInst = p_DmaPsInst;
+
+	/* Return initialisation result to calling code */
+	return status;
+
+}
+
+
+
+/*****************************************************************************
+ * Function: xDmaPsCopy()
+ *//**
+ *
+ * @brief		Copies len bytes from src to dst using the DMA controller.
+ *
+ * @return		XST_SUCCESS, XST_INVALID_PARAM (alignment/length), or
+ * 				XST_FAILURE (DMA fault or timeout).
+ *
+ * @note		Blocks the calling task until the copy is done (and while
+ * 				another task's transfer is in progress).
+ *
+****************************************************************************/
+
+int xDmaPsCopy(UINTPTR dst, UINTPTR src, u32 len)
+{
+	int status;
+
+	if (xDmaMutex == NULL)
+	{
+		return XST_FAILURE;
+	}
+
+	xSemaphoreTake(xDmaMutex, portMAX_DELAY);
+	status = xDmaPsTransfer(dst, src, len, 1U);
+	xSemaphoreGive(xDmaMutex);
+
+	return status;
+}
+
+
+
+/*****************************************************************************
+ * Function: xDmaPsFill()
+ *//**
+ *
+ * @brief		Fills len bytes at dst with a 32-bit pattern using the DMA
+ * 				controller (fixed source address).
+ *
+ * @return		XST_SUCCESS, XST_INVALID_PARAM (alignment/length), or
+ * 				XST_FAILURE (DMA fault or timeout).
+ *
+ * @note		Blocks the calling task until the fill is done (and while
+ * 				another task's transfer is in progress).
+ *
+****************************************************************************/
+
+int xDmaPsFill(UINTPTR dst, u32 pattern, u32 len)
+{
+	int status;
+
+	if (xDmaMutex == NULL)
+	{
+		return XST_FAILURE;
+	}
+
+	xSemaphoreTake(xDmaMutex, portMAX_DELAY);
+	ulDmaFillPattern = pattern;
+	status = xDmaPsTransfer(dst, (UINTPTR)&ulDmaFillPattern, len, 0U);
+	xSemaphoreGive(xDmaMutex);
+
+	return status;
+}
+
+
+
+/*****************************************************************************
+ * Function: xDmaPsTransfer()
+ *//**
+ *
+ * @brief		Runs one transfer on PS7_DMA_CHANNEL and waits for it. The
+ * 				caller holds xDmaMutex.
+ *
+ * @details		The cache maintenance is:
+ * 				(1) Flush the source, so the DMA reads what the CPU wrote.
+ * 				(2) Flush the destination, so no dirty line is evicted on
+ * 					top of the DMA data later.
+ * 				(3) Invalidate the destination when done, so the CPU reads
+ * 					what the DMA wrote.
+ *
+ * 				The task blocks on a semaphore, given by the done or
+ * 				fault handler; the CPU is free for the other tasks meanwhile.
+ *
+ * 				On a timeout the channel is killed and the driver's record
+ * 				of the transfer (DmaCmdToHw and the generated DMA program)
+ * 				is released, as the done handler would have done; otherwise
+ * 				every later XDmaPs_Start() returns XST_DEVICE_BUSY.
+ *
+ * @return		XST_SUCCESS, XST_INVALID_PARAM or XST_FAILURE.
+ *
+ * @note		None.
+ *
+****************************************************************************/
+
+static int xDmaPsTransfer(UINTPTR dst, UINTPTR src, u32 len, unsigned int src_inc)
+{
+
+	int status;
+
+	if ( (p_DmaInst == NULL) || (len == 0U) || (len > DMA_MAX_TRANSFER_SIZE) ||
+		 (((dst | src | len) & 0x3U) != 0U) )
+	{
+		return XST_INVALID_PARAM;
+	}
+
+
+	/* Describe the transfer */
+	memset(&DmaCmd, 0, sizeof(DmaCmd));
+
+	DmaCmd.ChanCtrl.SrcBurstSize = DMA_BURST_SIZE;
+	DmaCmd.ChanCtrl.SrcBurstLen = DMA_BURST_LEN;
+	DmaCmd.ChanCtrl.SrcInc = src_inc;
+	DmaCmd.ChanCtrl.DstBurstSize = DMA_BURST_SIZE;
+	DmaCmd.ChanCtrl.DstBurstLen = DMA_BURST_LEN;
+	DmaCmd.ChanCtrl.DstInc = 1U;
+
+	DmaCmd.BD.SrcAddr = (u32)src;
+	DmaCmd.BD.DstAddr = (u32)dst;
+	DmaCmd.BD.Length = len;
+
+
+	/* Cache maintenance before the transfer */
+	Xil_DCacheFlushRange((INTPTR)src, src_inc ? len : sizeof(u32));
+	Xil_DCacheFlushRange((INTPTR)dst, len);
+
+
+	/* Start, then wait for the done/fault handler. A semaphore left over
+	 * from a transfer that timed out is cleared first. */
+	xDmaResult = XST_FAILURE;
+	(void)xSemaphoreTake(xDmaDoneSemaphore, 0);
+
+	status = XDmaPs_Start(p_DmaInst, PS7_DMA_CHANNEL, &DmaCmd, 0);
+	if (status != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	if (xSemaphoreTake(xDmaDoneSemaphore, pdMS_TO_TICKS(DMA_TIMEOUT_MS)) != pdTRUE)
+	{
+		XDmaPs_ResetChannel(p_DmaInst, PS7_DMA_CHANNEL);
+
+		/* The done interrupt may still have come in just before the kill:
+		 * only release the command if the handler has not. */
+		taskENTER_CRITICAL();
+		if (p_DmaInst->Chans[PS7_DMA_CHANNEL].DmaCmdToHw != NULL)
+		{
+			(void)XDmaPs_FreeDmaProg(p_DmaInst, PS7_DMA_CHANNEL, &DmaCmd);
+			p_DmaInst->Chans[PS7_DMA_CHANNEL].DmaCmdToHw = NULL;
+		}
+		taskEXIT_CRITICAL();
+
+		status = XST_FAILURE;
+	}
+	else
+	{
+		status = xDmaResult;
+	}
+
+
+	/* Cache maintenance after the transfer */
+	Xil_DCacheInvalidateRange((INTPTR)dst, len);
+
+	return status;
+
+}
+
+
+
+
+/*============================================*/
+/* =========== INTERRUPT HANDLERS ============*/
+/*============================================*/
+
+
+/*****************************************************************************
+ * Function: vDmaDoneHandler()
+ *//**
+ *
+ * @brief		Called by XDmaPs_DoneISR_0() when the channel completes.
+ * 				Wakes the task waiting in xDmaPsTransfer().
+ *
+******************************************************************************/
+
+static void vDmaDoneHandler(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	xDmaResult = XST_SUCCESS;
+
+	xSemaphoreGiveFromISR(xDmaDoneSemaphore, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+
+/*****************************************************************************
+ * Function: vDmaFaultHandler()
+ *//**
+ *
+ * @brief		Called by XDmaPs_FaultISR() if the channel faults (e.g. bus
+ * 				error on a bad address). Wakes the waiting task with a failure.
+ *
+******************************************************************************/
+
+static void vDmaFaultHandler(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	xDmaResult = XST_FAILURE;
+
+	xSemaphoreGiveFromISR(xDmaDoneSemaphore, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
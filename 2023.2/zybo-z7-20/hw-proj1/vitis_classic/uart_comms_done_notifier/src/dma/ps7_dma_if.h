@@ -0,0 +1,93 @@
+/******************************************************************************
+ * @Title		:	PS7 DMA Controller Interface (Header File)
+ * @Filename	:	ps7_dma_if.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+#ifndef SRC_DMA_PS7_DMA_IF_H_
+#define SRC_DMA_PS7_DMA_IF_H_
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+/* Xilinx low-level */
+#include "xdmaps.h"
+#include "xscugic.h"
+
+/* FreeRTOS (transfers block the calling task until the DMA is done) */
+#include "FreeRTOS.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+#define DMA_DEBUG						0
+
+/* Device ID: PS7_DMA_S. A single channel is used for all transfers. */
+#define PS7_DMA_DEVICE_ID			XPAR_XDMAPS_1_DEVICE_ID
+#define PS7_DMA_CHANNEL				0U
+
+/* Interrupt Parameters */
+#define DMA_DONE_INTR_ID			XPS_DMA0_INT_ID			// Channel 0 done, 46U
+#define DMA_FAULT_INTR_ID			XPS_DMA0_ABORT_INT_ID	// DMAC abort, 45U
+#define DMA_INTR_PRI				(0xB0)
+#define DMA_INTR_TRIG				(0x01) // Active-high Level Sensitive
+
+
+/* Transfer parameters. Addresses and lengths must be 32-bit aligned. */
+#define DMA_BURST_SIZE				4U		// Bytes per beat
+#define DMA_BURST_LEN				16U		// Beats per burst
+#define DMA_MAX_TRANSFER_SIZE		(1024U * 1024U)
+
+/* Longest wait for a transfer to complete (1 MB takes a few ms). */
+#define DMA_TIMEOUT_MS				100U
+
+
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+/* Device Initialization */
+/* p_DmaPsInst must be passed by reference from calling code. */
+int xDmaPsInit(XDmaPs* p_DmaPsInst, XScuGic* p_xInterruptController);
+
+
+/* Interface functions. These block the calling task (not the CPU) until the
+ * transfer is done, and handle the data cache maintenance. Transfers from
+ * different tasks are run one after the other. */
+int xDmaPsCopy(UINTPTR dst, UINTPTR src, u32 len);
+int xDmaPsFill(UINTPTR dst, u32 pattern, u32 len);
+
+
+
+
+#endif /* SRC_DMA_PS7_DMA_IF_H_ */
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * @Title		:	Deferred Interrupt Handling Source File
+ * @Filename	:	deferred_irq.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "deferred_irq.h"
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+static void vDeferredIrqTask(void* pvParameters);
+static void vDeferredIrqIntrHandler(void* CallBackRef);
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/*****************************************************************************
+ * Function: xDeferredIrqCreate()
+ *//**
+ *
+ * @brief		Creates the handler task of a deferred interrupt source.
+ *
+ * @details		p_xIrq must stay valid for as long as the task runs (static).
+ * 				fp_Handler is called in the task, with p_Arg, each time it
+ * 				is woken by the interrupt.
+ *
+ * @return		XST_SUCCESS or XST_FAILURE (task not created).
+ *
+****************************************************************************/
+
+int xDeferredIrqCreate(DeferredIrq_s* p_xIrq,
+				const char* p_Name,
+				UBaseType_t priority,
+				DeferredIrqHandler_t fp_Handler,
+				void* p_Arg)
+{
+	if ( (p_xIrq == NULL) || (fp_Handler == NULL) )
+	{
+		return XST_FAILURE;
+	}
+
+	p_xIrq->fpHandler = fp_Handler;
+	p_xIrq->pvArg = p_Arg;
+	p_xIrq->ulStatus = 0U;
+	p_xIrq->ulHandledCount = 0U;
+	p_xIrq->ulBacklogCount = 0U;
+	p_xIrq->ulMaxBacklog = 0U;
+
+	if (xTaskCreate( vDeferredIrqTask,
+					p_Name,
+					DEFERRED_IRQ_STACK_SIZE,
+					(void *) p_xIrq,
+					priority,
+					&p_xIrq->xTask ) != pdPASS)
+	{
+		p_xIrq->xTask = NULL;
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************
+ * Function: xDeferredIrqConnect()
+ *//**
+ *
+ * @brief		Connects, prioritises and enables a GIC interrupt. The
+ * 				interrupt calls fp_Ack(p_Device) and then wakes the handler
+ * 				task.
+ *
+ * @note		The priority must be at or below (numerically at or above)
+ * 				configMAX_API_CALL_INTERRUPT_PRIORITY, as the ISR uses the
+ * 				FreeRTOS API.
+ *
+ * @return		XST_SUCCESS or XST_FAILURE.
+ *
+****************************************************************************/
+
+int xDeferredIrqConnect(DeferredIrq_s* p_xIrq,
+				XScuGic* p_xInterruptController,
+				uint32_t intr_id,
+				uint8_t priority,
+				uint8_t trigger,
+				DeferredIrqAck_t fp_Ack,
+				void* p_Device)
+{
+	int status;
+
+	if (fp_Ack == NULL)
+	{
+		return XST_FAILURE;
+	}
+
+	p_xIrq->fpAck = fp_Ack;
+	p_xIrq->pvDevice = p_Device;
+
+	status = XScuGic_Connect(p_xInterruptController, intr_id,
+				  (Xil_ExceptionHandler) vDeferredIrqIntrHandler,
+				  (void *) p_xIrq);
+	if (status != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	XScuGic_SetPriorityTriggerType(p_xInterruptController, intr_id, priority, trigger);
+	XScuGic_Enable(p_xInterruptController, intr_id);
+
+	return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************
+ * Function: vDeferredIrqNotifyFromISR()
+ *//**
+ *
+ * @brief		Wakes the handler task (interrupt context). status is ORed
+ * 				into the status passed to the handler.
+ *
+ * @details		vTaskNotifyGiveFromISR() increments the task's notification
+ * 				value, so each call is one event for the handler, whether or
+ * 				not the task has run since the last one. It is cheaper than
+ * 				giving a semaphore: no queue, and no list of waiting tasks.
+ *
+****************************************************************************/
+
+void vDeferredIrqNotifyFromISR(DeferredIrq_s* p_xIrq, uint32_t status,
+				BaseType_t* p_xHigherPriorityTaskWoken)
+{
+	if (p_xIrq->xTask == NULL)
+	{
+		p_xIrq->ulDroppedCount++;
+		return;
+	}
+
+	p_xIrq->ulStatus |= status;
+	p_xIrq->ulEventCount++;
+	vTaskNotifyGiveFromISR(p_xIrq->xTask, p_xHigherPriorityTaskWoken);
+}
+
+
+
+/*****************************************************************************
+ * Function: vDeferredIrqIntrHandler()
+ *//**
+ *
+ * @brief		Interrupt handler of the sources connected with
+ * 				xDeferredIrqConnect(): acknowledge, notify, and switch to
+ * 				the handler task if it has the higher priority.
+ *
+****************************************************************************/
+
+static void vDeferredIrqIntrHandler(void* CallBackRef)
+{
+	DeferredIrq_s *pxIrq = (DeferredIrq_s *) CallBackRef;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	vDeferredIrqNotifyFromISR(pxIrq, pxIrq->fpAck(pxIrq->pvDevice), &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+
+/*****************************************************************************
+ * Function: vDeferredIrqTask()
+ *//**
+ *
+ * @brief		Handler task: waits for the interrupt, then calls the handler
+ * 				with the number of events taken and their status.
+ *
+****************************************************************************/
+
+static void vDeferredIrqTask(void* pvParameters)
+{
+	DeferredIrq_s *pxIrq = (DeferredIrq_s *) pvParameters;
+	uint32_t ulEvents;
+	uint32_t ulStatus;
+
+	for (;;)
+	{
+		// Takes (and clears) all the events given since the last time.
+		ulEvents = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if (ulEvents == 0U)
+		{
+			continue;
+		}
+
+		/* Only pay for the critical section when the ISR passed a status. */
+		ulStatus = 0U;
+		if (pxIrq->ulStatus != 0U)
+		{
+			taskENTER_CRITICAL();
+			ulStatus = pxIrq->ulStatus;
+			pxIrq->ulStatus = 0U;
+			taskEXIT_CRITICAL();
+		}
+
+		pxIrq->ulHandledCount += ulEvents;
+		pxIrq->ulBacklogCount += ulEvents - 1U;
+		if (ulEvents > pxIrq->ulMaxBacklog)
+		{
+			pxIrq->ulMaxBacklog = ulEvents;
+		}
+
+		pxIrq->fpHandler(pxIrq->pvArg, ulEvents, ulStatus);
+	}
+}
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
@@ -0,0 +1,125 @@
+/******************************************************************************
+ * @Title		:	Deferred Interrupt Handling (Header File)
+ * @Filename	:	deferred_irq.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+#ifndef SRC_DEFERRED_IRQ_H_
+#define SRC_DEFERRED_IRQ_H_
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+/* FreeRTOS */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Xilinx low-level */
+#include "xscugic.h"
+
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* Deferred interrupt handling. Each interrupt source gets one handler task,
+ * created by xDeferredIrqCreate(). The interrupt side only acknowledges the
+ * device and gives the task a direct-to-task notification; the work is done
+ * by the handler function, in the task.
+ *
+ * The notification value counts the events: the task takes all of them at
+ * once and the handler is told how many there were, so events that arrive
+ * while the handler is still busy are not lost, and are counted in
+ * ulBacklogCount.
+ *
+ * The layer owns the handler task's notification value (index 0): the
+ * handler function must not wait on notifications itself. */
+#define DEFERRED_IRQ_STACK_SIZE		configMINIMAL_STACK_SIZE
+
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+/* Acknowledge function. Called at the start of the interrupt with the device
+ * passed to xDeferredIrqConnect(); it must clear the interrupt in the device
+ * and only use ISR-safe calls. The value returned is ORed into the status
+ * passed to the handler (0 if there is nothing to pass on). */
+typedef uint32_t (*DeferredIrqAck_t)(void *pvDevice);
+
+/* Handler function, called in the handler task. ulEvents = interrupts since
+ * the last call (at least 1), ulStatus = OR of the acknowledge values. */
+typedef void (*DeferredIrqHandler_t)(void *pvArg, uint32_t ulEvents, uint32_t ulStatus);
+
+/* One deferred interrupt source. */
+typedef struct {
+	TaskHandle_t xTask;
+	DeferredIrqHandler_t fpHandler;
+	void *pvArg;
+	DeferredIrqAck_t fpAck;
+	void *pvDevice;
+	volatile uint32_t ulStatus;			// Acknowledge values not yet passed to the handler
+	volatile uint32_t ulEventCount;		// Interrupts (notifications given)
+	volatile uint32_t ulDroppedCount;	// Interrupts before the handler task was created
+	uint32_t ulHandledCount;			// Events passed to the handler
+	uint32_t ulBacklogCount;			// Events that found the handler still busy
+	uint32_t ulMaxBacklog;				// Most events in one handler call
+} DeferredIrq_s;
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Handler task. Create before the interrupt source is started. */
+int xDeferredIrqCreate(DeferredIrq_s* p_xIrq,
+				const char* p_Name,
+				UBaseType_t priority,
+				DeferredIrqHandler_t fp_Handler,
+				void* p_Arg);
+
+/* Connects, prioritises and enables a GIC interrupt with the layer's ISR. */
+int xDeferredIrqConnect(DeferredIrq_s* p_xIrq,
+				XScuGic* p_xInterruptController,
+				uint32_t intr_id,
+				uint8_t priority,
+				uint8_t trigger,
+				DeferredIrqAck_t fp_Ack,
+				void* p_Device);
+
+/* For sources dispatched by another handler (e.g. the TTC match service):
+ * wakes the handler task from that interrupt. */
+void vDeferredIrqNotifyFromISR(DeferredIrq_s* p_xIrq, uint32_t status,
+				BaseType_t* p_xHigherPriorityTaskWoken);
+
+
+#endif /* SRC_DEFERRED_IRQ_H_ */
@@ -35,6 +35,8 @@
 /***************************** Include Files *********************************/
 /*****************************************************************************/
 
+#include <string.h>
+
 #include "ttc_if.h"
 
 
@@ -44,6 +46,9 @@
 /************************** Constant Definitions *****************************/
 /*****************************************************************************/
 
+#define NS_PER_SECOND			1000000000ULL
+#define TTC_MAX_SHIFT			16U		// Prescaler 15 => divide by 2^16
+
 
 
 /*****************************************************************************/
@@ -68,6 +73,16 @@
 /************************** Function Prototypes ******************************/
 /*****************************************************************************/
 
+static int xTtcDeviceInit(uint16_t ttc_id, XTtcPs* p_XTtcPsInst);
+static int xTtcConnectIntr(uint16_t ttc_id, XScuGic* p_xInterruptController,
+				Xil_ExceptionHandler fp_IntrHandler, void* p_CallBackRef);
+static int xTtcCalcShift(uint32_t clock_hz, uint32_t period_ns,
+				uint32_t max_ticks, uint8_t* p_shift, uint32_t* p_ticks);
+static int xTtcMatchCalcTiming(TtcMatchService_s* p_xService);
+static uint32_t ulTtcTicksToNs(uint32_t clock_hz, uint8_t shift, uint32_t ticks);
+static void vTtcMatchServiceSlot(TtcMatchService_s* p_xService, uint32_t slot);
+static void vTtcMatchIntrHandler(void* CallBackRef);
+
 
 
 
@@ -102,7 +117,8 @@
  * @return		Integer indicating result of configuration attempt.
  * 				0 = SUCCESS, 1 = FAILURE
  *
- * @note		None
+ * @note		fp_IntrHandler = NULL skips step 5: the caller connects the
+ * 				interrupt (e.g. with xDeferredIrqConnect).
  *
 ******************************************************************************/
 
@@ -114,9 +130,397 @@ int xTtcInit(uint16_t ttc_id,
 
 	int status;
 
+	uint32_t PERIOD_NS = 0;
+	uint8_t PRESCALER = 0;
+	uint16_t INTERVAL = 0;
+
+
+	// Set period (i.e. periodic interrupt time)
+	if (ttc_id == 0) { PERIOD_NS = TTC0_0_PERIOD_NS; }
+	else if (ttc_id == 1) { PERIOD_NS = TTC0_1_PERIOD_NS; }
+	else { PERIOD_NS = TTC_DEFAULT_PERIOD_NS; }
+
+
+	/* === START CONFIGURATION SEQUENCE ===  */
+
+	/* ---------------------------------------------------------------------
+	 * ------------ STEPS 1-3: LOOK-UP, DRIVER INITIALISATION, SELF TEST ------------
+	 * -------------------------------------------------------------------- */
+	status = xTtcDeviceInit(ttc_id, p_XTtcPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 4: PROJECT-SPECIFIC CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+	/* Configuration steps are:
+	* (1) Work out prescaler and interval for the period.
+	* (2) Set clock control options (prescaler)
+	* (3) Set Interval mode.
+	* (4) Set Interval time.
+	* (5) Enable Interval interrupt.*/
+	status = xTtcCalcInterval(p_XTtcPsInst->Config.InputClockHz, PERIOD_NS,
+								&PRESCALER, &INTERVAL);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+	XTtcPs_SetPrescaler(p_XTtcPsInst, PRESCALER);
+	XTtcPs_SetOptions(p_XTtcPsInst, XTTCPS_OPTION_INTERVAL_MODE);
+	XTtcPs_SetInterval(p_XTtcPsInst, INTERVAL);
+	XTtcPs_EnableInterrupts(p_XTtcPsInst, XTTCPS_IXR_INTERVAL_MASK );
+
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 5: INTERRUPT CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+	if (fp_IntrHandler != NULL)
+	{
+		status = xTtcConnectIntr(ttc_id, p_xInterruptController,
+									fp_IntrHandler, (void *) p_XTtcPsInst);
+	}
+
+
+	/* Return initialisation result to calling code */
+	return status;
+
+}
+
+
+
+
+/*****************************************************************************
+ * Function: xTtcMatchInit()
+ *//**
+ *
+ * @brief		Configures a TTC counter as a match-register event service.
+ *
+ *
+ * @details		The counter runs free (overflow mode, no interval reset), and
+ * 				its three match registers are re-armed by the service interrupt
+ * 				handler to the next deadline of the events assigned to them.
+ * 				This releases up to TTC_MATCH_MAX_EVENTS periodic events from
+ * 				one counter and one GIC line, instead of a counter per event.
+ *
+ * 				The initialisation steps are:
+ * 				(1) - (3) As xTtcInit (look-up, driver init, self-test)
+ * 				(4) Match mode, free running; match interrupts stay disabled
+ * 				    until startTtcMatch().
+ * 				(5) Interrupt configuration, with the service as callback
+ * 				    reference.
+ *
+ * 				Events are then added with xTtcMatchAddEvent() and the counter
+ * 				started with startTtcMatch().
+ *
+ * @return		Integer indicating result of configuration attempt.
+ * 				0 = SUCCESS, 1 = FAILURE
+ *
+ * @note		None
+ *
+******************************************************************************/
+
+int xTtcMatchInit(uint16_t ttc_id,
+				TtcMatchService_s* p_xService,
+				XTtcPs* p_XTtcPsInst,
+				XScuGic* p_xInterruptController)
+{
+	int status;
+
+	memset(p_xService, 0, sizeof(*p_xService));
+	p_xService->pxTtc = p_XTtcPsInst;
+
+
+	/* ------------ STEPS 1-3: LOOK-UP, DRIVER INITIALISATION, SELF TEST ------------ */
+	status = xTtcDeviceInit(ttc_id, p_XTtcPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+	p_xService->ulClockHz = p_XTtcPsInst->Config.InputClockHz;
+
+
+	/* ------------ STEP 4: MATCH MODE, FREE RUNNING ------------ */
+	XTtcPs_SetPrescaler(p_XTtcPsInst, XTTCPS_CLK_CNTRL_PS_DISABLE);
+	XTtcPs_SetOptions(p_XTtcPsInst, XTTCPS_OPTION_MATCH_MODE);
+	XTtcPs_DisableInterrupts(p_XTtcPsInst, XTTCPS_IXR_ALL_MASK);
+
+
+	/* ------------ STEP 5: INTERRUPT CONFIGURATION ------------ */
+	return xTtcConnectIntr(ttc_id, p_xInterruptController,
+							vTtcMatchIntrHandler, (void *) p_xService);
+}
+
+
+
+
+/*****************************************************************************
+ * Function: xTtcMatchAddEvent()
+ *//**
+ *
+ * @brief		Adds a periodic event to a match-register service.
+ *
+ * @details		fp_Callback is called from the TTC interrupt every period_ns,
+ * 				the first time one period after startTtcMatch(). The prescaler
+ * 				is recalculated for the longest period added so far, so an
+ * 				event that no longer fits (shorter than one counter tick at
+ * 				that prescaler) is rejected here rather than at start-up.
+ *
+ * @return		XST_SUCCESS, or XST_FAILURE if the service is full or already
+ * 				started, or the periods cannot share the counter.
+ *
+ * @note		Must be called before startTtcMatch().
+ *
+******************************************************************************/
+
+int xTtcMatchAddEvent(TtcMatchService_s* p_xService,
+				uint32_t period_ns,
+				TtcMatchCallback_t fp_Callback,
+				void* p_Arg)
+{
+	TtcMatchEvent_s *p_xEvent;
+
+	if ( (p_xService->ucStarted != 0U) ||
+		 (p_xService->ucEventCount >= TTC_MATCH_MAX_EVENTS) ||
+		 (fp_Callback == NULL) )
+	{
+		return XST_FAILURE;
+	}
+
+	p_xEvent = &p_xService->xEvents[p_xService->ucEventCount];
+	p_xEvent->fpCallback = fp_Callback;
+	p_xEvent->pvArg = p_Arg;
+	p_xEvent->ulPeriodNs = period_ns;
+	p_xService->ucEventCount++;
+
+	if (xTtcMatchCalcTiming(p_xService) != XST_SUCCESS)
+	{
+		/* Drop the event again; the previous set still fits. */
+		p_xService->ucEventCount--;
+		(void) xTtcMatchCalcTiming(p_xService);
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+
+
+
+/*****************************************************************************
+ * Function: startTtc()
+ *//**
+ *
+ * @brief		Starts TTC by calling XTtcPs_Start().
+ *
+ * @return 		None
+ *
+ * @note		None
+ *
+****************************************************************************/
+
+void startTtc(XTtcPs* p_XTtcPsInst)
+{
+	XTtcPs_Start(p_XTtcPsInst);
+}
+
+
+
+/*****************************************************************************
+ * Function: resetTtc()
+ *//**
+ *
+ * @brief		Resets(and restarts) TTC by calling XTtcPs_ResetCounterValue().
+ *
+ * @return 		None
+ *
+ * @note		None
+ *
+****************************************************************************/
+
+void resetTtc(XTtcPs* p_XTtcPsInst)
+{
+	XTtcPs_ResetCounterValue(p_XTtcPsInst);
+}
+
+
+
+/*****************************************************************************
+ * Function: startTtcMatch()
+ *//**
+ *
+ * @brief		Arms the match registers of a match-register service and
+ * 				starts its counter from zero.
+ *
+ * @return 		None
+ *
+ * @note		Only the match interrupts that have events are enabled.
+ *
+****************************************************************************/
+
+void startTtcMatch(TtcMatchService_s* p_xService)
+{
+	XTtcPs *p_XTtcPsInst = p_xService->pxTtc;
+	uint32_t intr_mask = 0U;
+	uint32_t slot;
+	uint32_t i;
+
+	for (i = 0U; i < p_xService->ucEventCount; i++)
+	{
+		p_xService->xEvents[i].ulDeadlineFx = p_xService->xEvents[i].ulPeriodFx;
+	}
+
+	/* The counter is stopped at zero, so each register simply gets the
+	 * earliest first deadline of its events. */
+	for (slot = 0U; (slot < TTC_MATCH_REGISTERS) && (slot < p_xService->ucEventCount); slot++)
+	{
+		uint32_t next_fx = p_xService->xEvents[slot].ulDeadlineFx;
+
+		for (i = slot + TTC_MATCH_REGISTERS; i < p_xService->ucEventCount; i += TTC_MATCH_REGISTERS)
+		{
+			if (p_xService->xEvents[i].ulDeadlineFx < next_fx)
+			{
+				next_fx = p_xService->xEvents[i].ulDeadlineFx;
+			}
+		}
+
+		XTtcPs_SetMatchValue(p_XTtcPsInst, (u8)slot, (XMatchRegValue)(next_fx >> 16));
+		intr_mask |= (XTTCPS_IXR_MATCH_0_MASK << slot);
+	}
+
+	p_xService->ucStarted = 1U;
+
+	XTtcPs_ClearInterruptStatus(p_XTtcPsInst, XTTCPS_IXR_ALL_MASK);
+	XTtcPs_EnableInterrupts(p_XTtcPsInst, intr_mask);
+	XTtcPs_ResetCounterValue(p_XTtcPsInst);
+	XTtcPs_Start(p_XTtcPsInst);
+}
+
+
+
+/*****************************************************************************
+ * Function: xTtcCalcInterval()
+ *//**
+ *
+ * @brief		Works out the prescaler and interval value for a period in
+ * 				interval mode.
+ *
+ * @details		Uses the smallest prescaler (i.e. the finest resolution) for
+ * 				which the period fits in the 16-bit interval register. The
+ * 				counter runs from 0 to the interval value, so the interval is
+ * 				one less than the number of counts in the period.
+ *
+ * @return		XST_SUCCESS, or XST_FAILURE if the period is shorter than two
+ * 				counts or longer than the counter can reach (~38.6s at 111MHz).
+ *
+ * @note		*p_prescaler is XTTCPS_CLK_CNTRL_PS_DISABLE when no division
+ * 				is needed, as expected by XTtcPs_SetPrescaler().
+ *
+****************************************************************************/
+
+int xTtcCalcInterval(uint32_t clock_hz, uint32_t period_ns,
+				uint8_t* p_prescaler, uint16_t* p_interval)
+{
+	uint8_t shift;
+	uint32_t ticks;
+
+	if (xTtcCalcShift(clock_hz, period_ns, TTC_INTERVAL_MAX + 1U, &shift, &ticks) != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	if (ticks < 2U)
+	{
+		return XST_FAILURE;
+	}
+
+	*p_prescaler = (shift == 0U) ? XTTCPS_CLK_CNTRL_PS_DISABLE : (uint8_t)(shift - 1U);
+	*p_interval = (uint16_t)(ticks - 1U);
+
+	return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************
+ * Function: ulTtcElapsedNs()
+ *//**
+ *
+ * @brief		Returns the time since the counter last restarted, in ns.
+ *
+ * @details		In interval mode the counter restarts from zero at the
+ * 				interval event, so, called from the interrupt handler before
+ * 				resetTtc(), this is the interrupt latency.
+ *
+ * @return 		Elapsed time in ns.
+ *
+ * @note		Wraps with the counter (after one interval).
+ *
+****************************************************************************/
+
+uint32_t ulTtcElapsedNs(XTtcPs* p_XTtcPsInst)
+{
+	uint8_t prescaler = XTtcPs_GetPrescaler(p_XTtcPsInst);
+	uint8_t shift = (prescaler >= XTTCPS_CLK_CNTRL_PS_DISABLE) ? 0U : (uint8_t)(prescaler + 1U);
+
+	return ulTtcTicksToNs(p_XTtcPsInst->Config.InputClockHz, shift,
+							(uint32_t)XTtcPs_GetCounterValue(p_XTtcPsInst));
+}
+
+
+
+/*****************************************************************************
+ * Function: ulTtcMatchLatencyNs()
+ *//**
+ *
+ * @brief		Returns the time since the deadline of the event being
+ * 				released, in ns (i.e. the interrupt latency of that release).
+ *
+ * @return 		Elapsed time in ns.
+ *
+ * @note		Only valid inside a match event callback.
+ *
+****************************************************************************/
+
+uint32_t ulTtcMatchLatencyNs(const TtcMatchService_s* p_xService)
+{
+	uint16_t now = (uint16_t)XTtcPs_GetCounterValue(p_xService->pxTtc);
+
+	return ulTtcTicksToNs(p_xService->ulClockHz, p_xService->ucShift,
+							(uint16_t)(now - (uint16_t)(p_xService->ulActiveDeadlineFx >> 16)));
+}
+
+
+
+/*---------------------------------------------------------------------------*/
+/*--------------------------- STATIC FUNCTIONS ------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/*****************************************************************************
+ * Function: xTtcDeviceInit()
+ *//**
+ *
+ * @brief		Device look-up, driver initialisation and self-test for one
+ * 				TTC counter (ttc_id 0-2 = TTC0-0..2, 3-5 = TTC1-0..2).
+ *
+ * @return		XST_SUCCESS or the failing driver status.
+ *
+****************************************************************************/
+
+static int xTtcDeviceInit(uint16_t ttc_id, XTtcPs* p_XTtcPsInst)
+{
+	int status;
 
 	uint16_t TTC_DEVICE_ID = 0;
-	uint16_t INTERVAL = 0;
 
 	// Set device id
 	if (ttc_id == 0) { TTC_DEVICE_ID = PS7_TTC0_DEVICE_ID; }
@@ -125,26 +529,13 @@ int xTtcInit(uint16_t ttc_id,
 	else if (ttc_id == 3) { TTC_DEVICE_ID = PS7_TTC3_DEVICE_ID; }
 	else if (ttc_id == 4) { TTC_DEVICE_ID = PS7_TTC4_DEVICE_ID; }
 	else if (ttc_id == 5) { TTC_DEVICE_ID = PS7_TTC5_DEVICE_ID; }
-
-
-	// Set Interval (i.e. periodic interrupt time)
-	if (ttc_id == 0) { INTERVAL = INTERVAL_75US; }
-	else if (ttc_id == 1) { INTERVAL = INTERVAL_100US; }
-	else if (ttc_id == 2) { INTERVAL = INTERVAL_500US; }
-	else if (ttc_id == 3) { INTERVAL = INTERVAL_500US; }
-	else if (ttc_id == 4) { INTERVAL = INTERVAL_500US; }
-	else if (ttc_id == 5) { INTERVAL = INTERVAL_500US; }
-
-
-
+	else { return XST_FAILURE; }
 
 
 	/* Pointer to XTtcPs_Config is required for later functions. */
 	XTtcPs_Config *p_XTtc0PsCfg = NULL;
 
 
-	/* === START CONFIGURATION SEQUENCE ===  */
-
 	/* ---------------------------------------------------------------------
 	 * ------------ STEP 1: DEVICE LOOK-UP ------------
 	 * -------------------------------------------------------------------- */
@@ -177,32 +568,26 @@ int xTtcInit(uint16_t ttc_id,
 
 	/* If the assertion test fails, we won't get here, but
 	* leave the code in anyway, for possible future changes. */
-	if (status != XST_SUCCESS)
-	{
-		return status;
-	}
-
+	return status;
+}
 
 
 
-	/* ---------------------------------------------------------------------
-	* ------------ STEP 4: PROJECT-SPECIFIC CONFIGURATION ------------
-	* -------------------------------------------------------------------- */
-	/* Configuration steps are:
-	* (1) Set clock control options (prescaler)
-	* (2) Set Interval mode.
-	* (3) Set Interval time.
-	* (4) Enable Interval interrupt.*/
-	XTtcPs_SetPrescaler(p_XTtcPsInst, PRESCALER_VALUE);
-	XTtcPs_SetOptions(p_XTtcPsInst, XTTCPS_OPTION_INTERVAL_MODE);
-	XTtcPs_SetInterval(p_XTtcPsInst, INTERVAL);
-	XTtcPs_EnableInterrupts(p_XTtcPsInst, XTTCPS_IXR_INTERVAL_MASK );
-
-
+/*****************************************************************************
+ * Function: xTtcConnectIntr()
+ *//**
+ *
+ * @brief		Connects, prioritises and enables the GIC interrupt of one
+ * 				TTC counter.
+ *
+ * @return		XST_SUCCESS or XST_FAILURE.
+ *
+****************************************************************************/
 
-	/* ---------------------------------------------------------------------
-	* ------------ STEP 5: INTERRUPT CONFIGURATION ------------
-	* -------------------------------------------------------------------- */
+static int xTtcConnectIntr(uint16_t ttc_id, XScuGic* p_xInterruptController,
+				Xil_ExceptionHandler fp_IntrHandler, void* p_CallBackRef)
+{
+	int status;
 
 	uint32_t TTC_INTR_ID = 0;
 
@@ -213,12 +598,13 @@ int xTtcInit(uint16_t ttc_id,
 	else if (ttc_id == 3) { TTC_INTR_ID = TTC1_0_INT_ID; }
 	else if (ttc_id == 4) { TTC_INTR_ID = TTC1_1_INT_ID; }
 	else if (ttc_id == 5) { TTC_INTR_ID = TTC1_2_INT_ID; }
+	else { return XST_FAILURE; }
 
 	/* Interrupt configuration */
-	/* Connect a device driver handler for Uart1 */
+	/* Connect the handler for this TTC */
 	status = XScuGic_Connect(p_xInterruptController, TTC_INTR_ID,
 				  (Xil_ExceptionHandler) fp_IntrHandler,
-				  (void *) p_XTtcPsInst);
+				  p_CallBackRef);
 	if (status != XST_SUCCESS)
 	{
 		return XST_FAILURE;
@@ -235,49 +621,223 @@ int xTtcInit(uint16_t ttc_id,
 	/* Enable the interrupt for the TTC */
 	XScuGic_Enable(p_xInterruptController, TTC_INTR_ID);
 
+	return XST_SUCCESS;
+}
 
-	/* Return initialisation result to calling code */
-	return status;
 
-}
 
+/*****************************************************************************
+ * Function: xTtcCalcShift()
+ *//**
+ *
+ * @brief		Finds the smallest clock division 2^shift (0 = prescaler
+ * 				disabled, 1..16 = prescaler 0..15) for which period_ns is
+ * 				less than max_ticks counts, and that number of counts
+ * 				(rounded to nearest).
+ *
+ * @return		XST_SUCCESS, or XST_FAILURE if no prescaler is large enough.
+ *
+****************************************************************************/
+
+static int xTtcCalcShift(uint32_t clock_hz, uint32_t period_ns,
+				uint32_t max_ticks, uint8_t* p_shift, uint32_t* p_ticks)
+{
+	uint64_t product = (uint64_t)period_ns * clock_hz;
+	uint64_t ticks;
+	uint8_t shift;
+
+	for (shift = 0U; shift <= TTC_MAX_SHIFT; shift++)
+	{
+		uint64_t divisor = NS_PER_SECOND << shift;
+
+		ticks = (product + (divisor / 2U)) / divisor;
+		if (ticks < max_ticks)
+		{
+			*p_shift = shift;
+			*p_ticks = (uint32_t)ticks;
+			return XST_SUCCESS;
+		}
+	}
+
+	return XST_FAILURE;
+}
 
 
 
 /*****************************************************************************
- * Function: startTtc()
+ * Function: xTtcMatchCalcTiming()
  *//**
  *
- * @brief		Starts TTC by calling XTtcPs_Start().
+ * @brief		Chooses the prescaler of a match-register service for its
+ * 				longest period, and converts every period to 16.16 ticks.
  *
- * @return 		None
+ * @details		The longest period must stay within TTC_MATCH_MAX_TICKS, so
+ * 				that a deadline is never more than half the counter range
+ * 				ahead of the counter, and every period must be at least one
+ * 				count at the chosen prescaler.
  *
- * @note		None
+ * @return		XST_SUCCESS or XST_FAILURE.
  *
 ****************************************************************************/
 
-void startTtc(XTtcPs* p_XTtcPsInst)
+static int xTtcMatchCalcTiming(TtcMatchService_s* p_xService)
 {
-	XTtcPs_Start(p_XTtcPsInst);
+	uint32_t longest_ns = 0U;
+	uint32_t ticks;
+	uint8_t shift = 0U;
+	uint32_t i;
+
+	for (i = 0U; i < p_xService->ucEventCount; i++)
+	{
+		if (p_xService->xEvents[i].ulPeriodNs > longest_ns)
+		{
+			longest_ns = p_xService->xEvents[i].ulPeriodNs;
+		}
+	}
+
+	if ( (longest_ns != 0U) &&
+		 (xTtcCalcShift(p_xService->ulClockHz, longest_ns,
+						TTC_MATCH_MAX_TICKS + 1U, &shift, &ticks) != XST_SUCCESS) )
+	{
+		return XST_FAILURE;
+	}
+
+	for (i = 0U; i < p_xService->ucEventCount; i++)
+	{
+		/* period * clock / 2^shift in 16.16: the product is at most
+		 * 2^15 counts * 2^shift * 1e9, so the shift by (16 - shift) stays
+		 * below 2^61. */
+		uint64_t period_fx = ((uint64_t)p_xService->xEvents[i].ulPeriodNs * p_xService->ulClockHz)
+								<< (16U - shift);
+		period_fx = (period_fx + (NS_PER_SECOND / 2U)) / NS_PER_SECOND;
+
+		if ( (period_fx < (1UL << 16)) || (period_fx > ((uint64_t)TTC_MATCH_MAX_TICKS << 16)) )
+		{
+			return XST_FAILURE;
+		}
+
+		p_xService->xEvents[i].ulPeriodFx = (uint32_t)period_fx;
+	}
+
+	p_xService->ucShift = shift;
+	XTtcPs_SetPrescaler(p_xService->pxTtc,
+						(shift == 0U) ? XTTCPS_CLK_CNTRL_PS_DISABLE : (uint8_t)(shift - 1U));
+
+	return XST_SUCCESS;
 }
 
 
 
 /*****************************************************************************
- * Function: resetTtc()
+ * Function: ulTtcTicksToNs()
  *//**
  *
- * @brief		Resets(and restarts) TTC by calling XTtcPs_ResetCounterValue().
+ * @brief		Converts counter ticks at clock_hz / 2^shift to ns.
  *
- * @return 		None
+****************************************************************************/
+
+static uint32_t ulTtcTicksToNs(uint32_t clock_hz, uint8_t shift, uint32_t ticks)
+{
+	if (clock_hz == 0U)
+	{
+		return 0U;
+	}
+
+	return (uint32_t)((((uint64_t)ticks << shift) * NS_PER_SECOND) / clock_hz);
+}
+
+
+
+/*****************************************************************************
+ * Function: vTtcMatchServiceSlot()
+ *//**
  *
- * @note		None
+ * @brief		Releases the due events of one match register and re-arms it
+ * 				to the earliest next deadline.
+ *
+ * @details		A match only fires when the counter equals the register, so
+ * 				if the next deadline has already gone by when the register is
+ * 				written (callbacks took long, or two deadlines are a few counts
+ * 				apart) it is handled here straight away instead of a full
+ * 				counter wrap later. Deadlines more than one period late are
+ * 				skipped and counted in ulMissedCount, so a stall gives one
+ * 				release rather than a burst.
  *
 ****************************************************************************/
 
-void resetTtc(XTtcPs* p_XTtcPsInst)
+static void vTtcMatchServiceSlot(TtcMatchService_s* p_xService, uint32_t slot)
 {
-	XTtcPs_ResetCounterValue(p_XTtcPsInst);
+	XTtcPs *p_XTtcPsInst = p_xService->pxTtc;
+	uint16_t now;
+	uint16_t match;
+	uint32_t next_fx;
+	uint32_t i;
+
+	do
+	{
+		now = (uint16_t)XTtcPs_GetCounterValue(p_XTtcPsInst);
+		next_fx = 0U;
+
+		for (i = slot; i < p_xService->ucEventCount; i += TTC_MATCH_REGISTERS)
+		{
+			TtcMatchEvent_s *p_xEvent = &p_xService->xEvents[i];
+
+			if ((int16_t)((uint16_t)(p_xEvent->ulDeadlineFx >> 16) - now) <= 0)
+			{
+				p_xService->ulActiveDeadlineFx = p_xEvent->ulDeadlineFx;
+				p_xEvent->fpCallback(p_xEvent->pvArg);
+				p_xEvent->ulReleaseCount++;
+				p_xEvent->ulDeadlineFx += p_xEvent->ulPeriodFx;
+
+				while ((int16_t)((uint16_t)(p_xEvent->ulDeadlineFx >> 16) - now) <= 0)
+				{
+					p_xEvent->ulDeadlineFx += p_xEvent->ulPeriodFx;
+					p_xEvent->ulMissedCount++;
+				}
+			}
+
+			if ((i == slot) || ((int32_t)(p_xEvent->ulDeadlineFx - next_fx) < 0))
+			{
+				next_fx = p_xEvent->ulDeadlineFx;
+			}
+		}
+
+		match = (uint16_t)(next_fx >> 16);
+		XTtcPs_WriteReg(p_XTtcPsInst->Config.BaseAddress,
+						XTtcPs_Match_N_Offset(slot), match);
+
+	} while ((int16_t)(match - (uint16_t)XTtcPs_GetCounterValue(p_XTtcPsInst)) <= 0);
+}
+
+
+
+/*****************************************************************************
+ * Function: vTtcMatchIntrHandler()
+ *//**
+ *
+ * @brief		TTC interrupt handler of a match-register service (the
+ * 				callback reference is the service). Services every match
+ * 				register whose interrupt is pending.
+ *
+****************************************************************************/
+
+static void vTtcMatchIntrHandler(void* CallBackRef)
+{
+	TtcMatchService_s *p_xService = (TtcMatchService_s *) CallBackRef;
+	uint32_t status_event;
+	uint32_t slot;
+
+	/* Get and clear the TTC interrupt status. */
+	status_event = XTtcPs_GetInterruptStatus(p_xService->pxTtc);
+	XTtcPs_ClearInterruptStatus(p_xService->pxTtc, status_event);
+
+	for (slot = 0U; slot < TTC_MATCH_REGISTERS; slot++)
+	{
+		if ((status_event & (XTTCPS_IXR_MATCH_0_MASK << slot)) != 0U)
+		{
+			vTtcMatchServiceSlot(p_xService, slot);
+		}
+	}
 }
 
 
@@ -58,22 +58,29 @@
 #define PS7_TTC5_DEVICE_ID			XPAR_PS7_TTC_5_DEVICE_ID
 
 
-/* Counter match values */
-/* TTC Clock = 111MHz => Period = 9ns*/
-/* Prescaler disabled; resolution = 9ns
- * Note this limits the max time to ~589.8us */
-#define PRESCALER_VALUE			XTTCPS_CLK_CNTRL_PS_DISABLE
-
-#define INTERVAL_50US			5556U	// 50us (9ns x 5556)
-#define INTERVAL_75US			8333U	// 75us (9ns x 8333)
-#define INTERVAL_100US			11111U	// 100us (9ns x 11111)
-#define INTERVAL_200US			22222U	// 200us (9ns x 22222)
-#define INTERVAL_300US			33333U	// 300us (9ns x 33333)
-#define INTERVAL_400US			44444U	// 400us (9ns x 44444)
-#define INTERVAL_500US			55555U	// 500us (9ns x 55555)
-#define INTERVAL_580US			64444U	// 580us (9ns x 64444)
-
-#define INTERVAL_373US			41444U	// 400us (9ns x 41444)
+/* Interval-mode periods (xTtcInit).
+ * TTC Clock = 111MHz => 9ns per count with the prescaler disabled. The
+ * counter is 16 bits, so xTtcCalcInterval() picks the smallest prescaler
+ * (divide by 2^(N+1), N = 0..15) that fits the requested period; the longest
+ * period is therefore ~38.6s, and the resolution halves each time the
+ * period doubles beyond ~589.8us. */
+#define TTC0_0_PERIOD_NS		75000U		// 75us
+#define TTC0_1_PERIOD_NS		100000U		// 100us
+#define TTC_DEFAULT_PERIOD_NS	500000U		// 500us (TTC0-2, TTC1-x)
+
+#define TTC_INTERVAL_MAX		0xFFFFU		// 16-bit counter
+
+
+/* Match-register service (xTtcMatchInit).
+ * One free-running counter and its three match registers release up to
+ * TTC_MATCH_MAX_EVENTS periodic events. Each match register is re-armed to
+ * the earliest deadline of the events assigned to it (event n uses match
+ * register n % 3). Deadlines are compared with the counter modulo 2^16, so
+ * the longest period must fit in half the counter range; the prescaler is
+ * chosen for the longest period and sets the resolution for all of them. */
+#define TTC_MATCH_MAX_EVENTS	16U
+#define TTC_MATCH_REGISTERS		3U
+#define TTC_MATCH_MAX_TICKS		0x7FFFU		// Half the 16-bit counter range
 
 
 // Interrupt settings
@@ -93,6 +100,34 @@
 /******************************* Typedefs ************************************/
 /*****************************************************************************/
 
+/* Match event callback. Called from the TTC interrupt handler, so it must
+ * only use ISR-safe calls (e.g. vDeferredIrqNotifyFromISR + portYIELD_FROM_ISR). */
+typedef void (*TtcMatchCallback_t)(void *pvArg);
+
+/* One periodic event. Times in 16.16 fixed-point counter ticks, so the
+ * fractional part of a period is carried from one release to the next and
+ * the average rate does not drift. */
+typedef struct {
+	TtcMatchCallback_t fpCallback;
+	void *pvArg;
+	uint32_t ulPeriodNs;
+	uint32_t ulPeriodFx;			// Period (ticks, 16.16)
+	uint32_t ulDeadlineFx;			// Next release (ticks, 16.16, modulo 2^16)
+	volatile uint32_t ulReleaseCount;
+	volatile uint32_t ulMissedCount;	// Releases skipped because the ISR was late
+} TtcMatchEvent_s;
+
+/* Match-register service on one TTC counter. */
+typedef struct {
+	XTtcPs *pxTtc;
+	uint32_t ulClockHz;
+	uint8_t ucShift;				// Clock divided by 2^ucShift (0 = prescaler disabled)
+	uint8_t ucEventCount;
+	uint8_t ucStarted;
+	uint32_t ulActiveDeadlineFx;	// Deadline of the event being released (ulTtcMatchLatencyNs)
+	TtcMatchEvent_s xEvents[TTC_MATCH_MAX_EVENTS];
+} TtcMatchService_s;
+
 
 
 /*****************************************************************************/
@@ -115,11 +150,29 @@ int xTtcInit(uint16_t ttc_id,
 				XScuGic* p_xInterruptController,
 				Xil_ExceptionHandler fp_IntrHandler);
 
+int xTtcMatchInit(uint16_t ttc_id,
+				TtcMatchService_s* p_xService,
+				XTtcPs* p_XTtcPsInst,
+				XScuGic* p_xInterruptController);
+
+int xTtcMatchAddEvent(TtcMatchService_s* p_xService,
+				uint32_t period_ns,
+				TtcMatchCallback_t fp_Callback,
+				void* p_Arg);
+
 
 
 /* Interface functions */
 void startTtc(XTtcPs* p_XTtcPsInst);
 void resetTtc(XTtcPs* p_XTtcPsInst);
+void startTtcMatch(TtcMatchService_s* p_xService);
+
+int xTtcCalcInterval(uint32_t clock_hz, uint32_t period_ns,
+				uint8_t* p_prescaler, uint16_t* p_interval);
+
+/* Interrupt latency: time from the TTC event to the call, in ns. */
+uint32_t ulTtcElapsedNs(XTtcPs* p_XTtcPsInst);
+uint32_t ulTtcMatchLatencyNs(const TtcMatchService_s* p_xService);
 
 
 
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * @Title		:	PS7 UART 0 Interface
+ * @Filename	:	ps7_uart0_if.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "ps7_uart0_if.h"
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+// Interrupt handlers, defined in main code:
+extern void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_data);
+extern void vUartCmdIntrHandler(void *CallBackRef);
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+/*****************************************************************************
+ * Function: xUartPs0Init()
+ *//**
+ *
+ * @brief		Configures UART0 for use as a second command channel.
+ *
+ *
+ * @details		Starts by doing device look-up, configuration and self-test.
+ * 				Then configures UART0 for this project.
+ *
+ * 				The initialisation steps are:
+ * 				(1) DEVICE LOOK-UP => Calls function "XUartPs_LookupConfig"
+ * 				(2) DRIVER INIT => Calls function "XUartPs_CfgInitialize"
+ * 				(3) SELF TEST => Calls function "XUartPs_SelfTest"
+ * 				(4) SPECIFIC CONFIG => Configures UART0 for this project
+ * 				(5) Interrupt configuration.
+ *
+ * 				If any of the first three states results in XST_FAILURE, the
+ * 				initialisation will stop and the XST_FAILURE code will be
+ * 				returned to the calling code. If initialisation completes with
+ * 				no failures, then XST_SUCCESS is returned.
+ *
+ * @return		Integer indicating result of configuration attempt.
+ * 				0 = SUCCESS, 1 = FAILURE
+ *
+ * @note		p_XUartPsInst and  p_xInterruptController must be passed by
+ * 				reference from calling code.
+ *
+******************************************************************************/
+
+int xUartPs0Init(XUartPs* p_XUartPsInst, XScuGic* p_xInterruptController)
+{
+	int status;
+
+	/* Pointer to XUartPs_Config is required for later functions. */
+	XUartPs_Config *p_XUartPsCfg = NULL;
+
+
+	/* === START CONFIGURATION SEQUENCE ===  */
+
+	/* ---------------------------------------------------------------------
+	 * ------------ STEP 1: DEVICE LOOK-UP ------------
+	 * -------------------------------------------------------------------- */
+	p_XUartPsCfg = XUartPs_LookupConfig(PS7_UART0_DEVICE_ID);
+ 	if (p_XUartPsCfg == NULL)
+	{
+ 		status = XST_FAILURE;
+ 		return status;
+	}
+
+
+ 	/* ---------------------------------------------------------------------
+	 * ------------ STEP 2: DRIVER INITIALISATION ------------
+	 * -------------------------------------------------------------------- */
+	status = XUartPs_CfgInitialize(p_XUartPsInst, p_XUartPsCfg, p_XUartPsCfg->BaseAddress);
+	if (status != XST_SUCCESS)
+	{
+ 		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 3: SELF TEST ------------
+	* -------------------------------------------------------------------- */
+ 	status = XUartPs_SelfTest(p_XUartPsInst);
+	Xil_AssertNonvoid(status == XST_SUCCESS);
+
+	/* If the assertion test fails, we won't get here, but
+	* leave the code in anyway, for possible future changes. */
+	if (status != XST_SUCCESS)
+	{
+		return status;
+	}
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 4: PROJECT-SPECIFIC CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+	/* Configuration steps are:
+	 * (1) Set the interrupt handler.
+	 * (2) Enable desired interrupts. The RX FIFO trigger level and receive
+	 *     timeout are set, and overrun errors are reported too (streaming
+	 *     mode only).
+	 * (3) Configure the UART in Normal Mode.*/
+
+	XUartPs_SetHandler(p_XUartPsInst, (XUartPs_Handler)vUartIntrHandlerForQueue, p_XUartPsInst);
+
+	XUartPs_SetFifoThreshold(p_XUartPsInst, UART0_RX_TRIGGER_LEVEL);
+	XUartPs_SetRecvTimeout(p_XUartPsInst, UART0_RX_TIMEOUT);
+	XUartPs_SetInterruptMask(p_XUartPsInst, XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT | XUARTPS_IXR_OVER );
+
+	XUartPs_SetOperMode(p_XUartPsInst, XUARTPS_OPER_MODE_NORMAL);
+
+
+
+	/* ---------------------------------------------------------------------
+	* ------------ STEP 5: INTERRUPT CONFIGURATION ------------
+	* -------------------------------------------------------------------- */
+
+	/* Interrupt configuration */
+	/* Connect the command channel handler for Uart0. It runs either its own
+	 * register-level handler or the driver's XUartPs_InterruptHandler
+	 * (which calls vUartIntrHandlerForQueue), see UART_CMD_FAST_ISR. */
+	status = XScuGic_Connect(p_xInterruptController, UART0_INTR_ID,
+				  (Xil_ExceptionHandler) vUartCmdIntrHandler,
+				  (void *) p_XUartPsInst);
+	if (status != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+
+	/* Set priority and trigger type */
+	XScuGic_SetPriorityTriggerType(p_xInterruptController,
+									UART0_INTR_ID,
+									UART0_INTR_PRI,
+									UART0_INTR_TRIG);
+
+
+	/* Enable the interrupt for Uart0 */
+	XScuGic_Enable(p_xInterruptController, UART0_INTR_ID);
+
+	/* Return initialisation result to calling code */
+	return status;
+
+}
+
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
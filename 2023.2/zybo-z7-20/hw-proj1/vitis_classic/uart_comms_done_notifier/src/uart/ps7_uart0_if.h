@@ -0,0 +1,79 @@
+/******************************************************************************
+ * @Title		:	PS7 UART 0 Interface  (Header File)
+ * @Filename	:	ps7_uart0_if.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+#ifndef SRC_UART_PS7_UART0_IF_H_
+#define SRC_UART_PS7_UART0_IF_H_
+
+
+/***************************** Include Files ********************************/
+
+/* Xilinx low-level */
+#include "xuartps.h"
+#include "xscugic.h"
+
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* UART0 is routed through EMIO to PMOD JB (see main_constraints.xdc). It is
+ * also the BSP's stdin/stdout, so it can carry commands only while the console
+ * is not in use. */
+
+/* Device ID */
+#define PS7_UART0_DEVICE_ID			XPAR_PS7_UART_0_DEVICE_ID
+
+/* Interrupt Parameters */
+#define UART0_INTR_ID				XPS_UART0_INT_ID 	// PS7 UART0, 59U
+#define UART0_INTR_PRI				(0xB8)	// Below the TTC interrupts (0xB0), which preempt it
+#define UART0_INTR_TRIG				(0x01) // Active-high Level Sensitive
+
+
+/* UART0 always runs in streaming mode (see UART1_RX_STREAMING). The FIFO
+ * helpers in ps7_uart1_if.h take the driver instance, and are used for UART0
+ * too. */
+#define UART0_RX_TRIGGER_LEVEL		(32U)	// Bytes in RX FIFO (1-63); leaves 32 bytes of headroom
+#define UART0_RX_TIMEOUT			(10U)	// Idle time, in units of 4 bit periods (1-255); 10 = 4 characters
+
+
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+/* Device Initialization */
+/* xUartPs0Init must be passed by reference from calling code. */
+
+int xUartPs0Init(XUartPs* p_XUartPsInst, XScuGic* xInterruptController);
+
+
+
+
+#endif /* SRC_UART_PS7_UART0_IF_H_ */
@@ -40,8 +40,9 @@
 /************************** Function Prototypes ******************************/
 /*****************************************************************************/
 
-// Interrupt handler, defined in main code:
+// Interrupt handlers, defined in main code:
 extern void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_data);
+extern void vUartCmdIntrHandler(void *CallBackRef);
 
 
 /*---------------------------------------------------------------------------*/
@@ -129,11 +130,21 @@ int xUartPs1Init(XUartPs* p_XUartPsInst, XScuGic* p_xInterruptController)
 	* -------------------------------------------------------------------- */
 	/* Configuration steps are:
 	 * (1) Set the interrupt handler.
-	 * (2) Enable desired interrupts. ('Receiver Full' is all that is needed.)
+	 * (2) Enable desired interrupts. In block mode 'Receiver Full' is all
+	 *     that is needed. In streaming mode the RX FIFO trigger level and
+	 *     receive timeout are set, and overrun errors are reported too.
 	 * (3) Configure the UART in Normal Mode.*/
 
 	XUartPs_SetHandler(p_XUartPsInst, (XUartPs_Handler)vUartIntrHandlerForQueue, p_XUartPsInst);
+
+#if UART1_RX_STREAMING
+	XUartPs_SetFifoThreshold(p_XUartPsInst, UART1_RX_TRIGGER_LEVEL);
+	XUartPs_SetRecvTimeout(p_XUartPsInst, UART1_RX_TIMEOUT);
+	XUartPs_SetInterruptMask(p_XUartPsInst, XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT | XUARTPS_IXR_OVER );
+#else
 	XUartPs_SetInterruptMask(p_XUartPsInst, XUARTPS_IXR_RXFULL );
+#endif
+
 	XUartPs_SetOperMode(p_XUartPsInst, XUARTPS_OPER_MODE_NORMAL);
 
 
@@ -143,9 +154,11 @@ int xUartPs1Init(XUartPs* p_XUartPsInst, XScuGic* p_xInterruptController)
 	* -------------------------------------------------------------------- */
 
 	/* Interrupt configuration */
-	/* Connect a device driver handler for Uart1 */
+	/* Connect the command channel handler for Uart1. It runs either its own
+	 * register-level handler or the driver's XUartPs_InterruptHandler
+	 * (which calls vUartIntrHandlerForQueue), see UART_CMD_FAST_ISR. */
 	status = XScuGic_Connect(p_xInterruptController, UART1_INTR_ID,
-				  (Xil_ExceptionHandler) XUartPs_InterruptHandler,
+				  (Xil_ExceptionHandler) vUartCmdIntrHandler,
 				  (void *) p_XUartPsInst);
 	if (status != XST_SUCCESS)
 	{
@@ -170,6 +183,114 @@ int xUartPs1Init(XUartPs* p_XUartPsInst, XScuGic* p_xInterruptController)
 
 
 
+
+/*****************************************************************************
+ * Function: ulUartPs1ReadFifo()
+ *//**
+ *
+ * @brief		Reads the bytes waiting in the UART1 RX FIFO.
+ *
+ * @details		Streaming mode only. Reads until the FIFO is empty or
+ * 				max_bytes have been read. The FIFO is read directly rather
+ * 				than through XUartPs_Recv(), which would leave the driver
+ * 				waiting for the rest of a fixed-size buffer.
+ *
+ * @return		Number of bytes read.
+ *
+ * @note		Called from the UART interrupt handler.
+ *
+******************************************************************************/
+
+uint32_t ulUartPs1ReadFifo(XUartPs* p_XUartPsInst, uint8_t *p_buffer, uint32_t max_bytes)
+{
+	UINTPTR base = p_XUartPsInst->Config.BaseAddress;
+	uint32_t count = 0U;
+
+	while ( (count < max_bytes) && XUartPs_IsReceiveData(base) )
+	{
+		p_buffer[count++] = (uint8_t)XUartPs_ReadReg(base, XUARTPS_FIFO_OFFSET);
+	}
+
+	return count;
+}
+
+
+
+/*****************************************************************************
+ * Function: vUartPs1RestartRxTimeout()
+ *//**
+ *
+ * @brief		Restarts the UART1 receive timeout counter.
+ *
+ * @details		Streaming mode only. Called after the FIFO has been drained,
+ * 				so that the next timeout interrupt marks the next idle period.
+ *
+ * @return		None.
+ *
+******************************************************************************/
+
+void vUartPs1RestartRxTimeout(XUartPs* p_XUartPsInst)
+{
+	UINTPTR base = p_XUartPsInst->Config.BaseAddress;
+
+	XUartPs_WriteReg(base, XUARTPS_CR_OFFSET,
+					 XUartPs_ReadReg(base, XUARTPS_CR_OFFSET) | XUARTPS_CR_TORST);
+}
+
+
+
+/*****************************************************************************
+ * Function: xUartPs1SetBaudRate()
+ *//**
+ *
+ * @brief		Changes the UART1 baud rate.
+ *
+ * @details		Waits for the transmitter to finish the byte it is sending
+ * 				(the TX FIFO empty interrupt fires before the last byte has
+ * 				left the shift register), then calls XUartPs_SetBaudRate().
+ * 				The driver resets both FIFOs, so any byte being received is
+ * 				lost; the host must be idle while the rate changes.
+ *
+ * @return		Integer indicating result of the change.
+ * 				0 = SUCCESS, 1 = FAILURE (rate out of range, transmitter
+ * 				still busy, or rate not reachable); the rate is unchanged on
+ * 				failure.
+ *
+******************************************************************************/
+
+int xUartPs1SetBaudRate(XUartPs* p_XUartPsInst, uint32_t baud_rate)
+{
+	UINTPTR base = p_XUartPsInst->Config.BaseAddress;
+	uint32_t wait = UART1_TX_IDLE_WAIT;
+
+	/* Range check first: XUartPs_SetBaudRate() asserts on its own limits. */
+	if ( (baud_rate < UART1_BAUD_RATE_MIN) || (baud_rate > UART1_BAUD_RATE_MAX) )
+	{
+		return XST_FAILURE;
+	}
+
+	while ( (!XUartPs_IsTransmitEmpty(p_XUartPsInst) ||
+			 ((XUartPs_ReadReg(base, XUARTPS_SR_OFFSET) & XUARTPS_SR_TACTIVE) != 0U)) &&
+			(wait != 0U) )
+	{
+		wait--;
+	}
+
+	if (wait == 0U)
+	{
+		return XST_FAILURE;
+	}
+
+	if (XUartPs_SetBaudRate(p_XUartPsInst, baud_rate) != XST_SUCCESS)
+	{
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+
+
 /****** End functions *****/
 
 /****** End of File **********************************************************/
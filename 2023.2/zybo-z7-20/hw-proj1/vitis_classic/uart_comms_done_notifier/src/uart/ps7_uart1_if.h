@@ -50,10 +50,35 @@
 
 /* Interrupt Parameters */
 #define UART1_INTR_ID				XPS_UART1_INT_ID 	// PS7 UART1, 82U
-#define UART1_INTR_PRI				(0xB0)
+#define UART1_INTR_PRI				(0xB8)	// Below the TTC interrupts (0xB0), which preempt it
 #define UART1_INTR_TRIG				(0x01) // Active-high Level Sensitive
 
 
+/* Receive mode.
+ * 0 = Block mode: the 'RX FIFO full' interrupt fires once 64 bytes have been
+ *     received, so frames must arrive as whole 64-byte blocks and any byte
+ *     received while the ISR is running can overflow the FIFO.
+ * 1 = Streaming mode: the 'RX FIFO trigger' interrupt fires at
+ *     UART1_RX_TRIGGER_LEVEL bytes and the 'receive timeout' interrupt picks
+ *     up the bytes left in the FIFO once the line goes idle. The ISR drains
+ *     the FIFO on both, and the frames are assembled in software. */
+#define UART1_RX_STREAMING			1
+
+/* Streaming mode parameters */
+#define UART1_RX_TRIGGER_LEVEL		(32U)	// Bytes in RX FIFO (1-63); leaves 32 bytes of headroom
+#define UART1_RX_TIMEOUT			(10U)	// Idle time, in units of 4 bit periods (1-255); 10 = 4 characters
+
+#define UART_FIFO_DEPTH				(64U)	// RX and TX FIFOs, both UARTs
+
+/* Run-time baud rate limits (see xUartPs1SetBaudRate). The UART reference clock
+ * is 100 MHz, so the driver can set any rate in this range to within its 3%
+ * error limit. The upper limit is the practical maximum for the USB-UART bridge
+ * on the Zybo; the UART itself can go higher. */
+#define UART1_BAUD_RATE_MIN			(9600U)
+#define UART1_BAUD_RATE_MAX			(3000000U)
+#define UART1_TX_IDLE_WAIT			(1000000U)	// Status register reads before giving up
+
+
 
 
 
@@ -74,6 +99,13 @@
 
 int xUartPs1Init(XUartPs* p_XUartPsInst, XScuGic* xInterruptController);
 
+/* Streaming mode helpers, called from the UART interrupt handler */
+uint32_t ulUartPs1ReadFifo(XUartPs* p_XUartPsInst, uint8_t *p_buffer, uint32_t max_bytes);
+void vUartPs1RestartRxTimeout(XUartPs* p_XUartPsInst);
+
+/* Run-time baud rate change */
+int xUartPs1SetBaudRate(XUartPs* p_XUartPsInst, uint32_t baud_rate);
+
 
 
 
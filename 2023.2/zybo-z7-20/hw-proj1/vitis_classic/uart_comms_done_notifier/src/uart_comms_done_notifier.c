@@ -44,14 +44,51 @@
 /* Xilinx includes. */
 #include "xuartps.h"
 #include "xscugic.h"
+#include "xtime_l.h"
+
+/* Standard includes. */
+#include <string.h>
 
 /* User includes. */
 #include "scugic/ps7_scugic_if.h"
+#include "scugic/deferred_irq.h"
+#include "uart/ps7_uart0_if.h"
 #include "uart/ps7_uart1_if.h"
 #include "gpio/ps7_gpio_if.h"
 #include "gpio/axi_gpio0_if.h"
 #include "gpio/axi_gpio1_if.h"
 #include "ttc/ttc_if.h"
+#include "dma/ps7_dma_if.h"
+#include "utilities/cmd_handler64B.h"
+#include "utilities/byte_ring.h"
+#include "utilities/pkt_pool.h"
+#include "utilities/cobs.h"
+#include "utilities/dlog.h"
+#include "utilities/timing_hist.h"
+
+
+#if UART0_CMD_CHANNEL
+/* UART0 carries commands: anything printed on the console (stdout) would be
+ * mixed into the responses. */
+#undef printf
+#define printf(...)
+#endif
+
+#if (UART1_CMD_FRAMING == CMD_FRAMING_COBS) && !UART1_RX_STREAMING
+#error "COBS framing needs the UART1 streaming receive mode"
+#endif
+
+#if UART0_CMD_CHANNEL && !DLOG_HOST_DECODE
+#error "The log cannot be printed on the console while UART0 carries commands"
+#endif
+
+#if UART_CMD_FAST_ISR && !UART1_RX_STREAMING
+#error "The register-level UART handler needs the UART1 streaming receive mode"
+#endif
+
+#if PKT_HEADROOM < COBS_MAX_OVERHEAD(PKT_BUFFER_SIZE)
+#error "PKT_HEADROOM is too small to COBS-encode a response in place"
+#endif
 
 
 /*****************************************************************************/
@@ -65,7 +102,10 @@
 #define TIMER_TASK2_PRI						3
 #define CMDHANDLE_RX_TASK_PRI				2
 #define CMDHANDLE_TX_TASK_PRI				2
+#define CMDHANDLE_WORKER_TASK_PRI			2
 #define NOTIFIED_TASK1_PRI					1
+#define LOG_FORMATTER_TASK_PRI				0
+#define LOOPBACK_BENCH_TASK_PRI				1
 
 
 
@@ -75,66 +115,368 @@ static TaskHandle_t BackgroundTask1_handle;
 /* End Task 1 defs */
 
 
-/* ------- Periodic Timer Tasks and Semaphores -------*/
-static void vPeriodicTimerTask1 ( void *pvParameters ); // Based on TTC0-0, toggle LED2
-static TaskHandle_t PeriodTimerTask1_handle;
+/* ------- Periodic Timer Tasks (deferred interrupts) -------*/
+static void vPeriodicTimerTask1 ( void *pvArg, uint32_t ulEvents, uint32_t ulStatus ); // Based on TTC0-0, toggle LED2
+static DeferredIrq_s xPeriodTimerTask1Irq;
 
-static void vPeriodicTimerTask2 ( void *pvParameters ); // Based on TTC0-1, toggle LED3
-static TaskHandle_t PeriodTimerTask2_handle;
-
-static SemaphoreHandle_t xPeriodTimerTask1Semaphore;
-static SemaphoreHandle_t xPeriodTimerTask2Semaphore;
-/* End Periodic Timer Tasks/semaphore defs */
+static void vPeriodicTimerTask2 ( void *pvArg, uint32_t ulEvents, uint32_t ulStatus ); // Based on TTC0-1, toggle LED3
+static DeferredIrq_s xPeriodTimerTask2Irq;
+/* End Periodic Timer Tasks defs */
 
 
 /* ----------------------- Notified task --------------------------- */
 static void vUartCommsDoneNotifiedTask( void *pvParameters );
+static TaskHandle_t xUartCommsDoneTask_h;
 
 /* End Notified Task 1 defs */
 
 
-/* ------------ Command handler tasks and queues -------------- */
+/* ----------------------- Deferred log --------------------------- */
 
-static void vCommandHandlerRxTask( void *pvParams);
-static TaskHandle_t rxCommandHandler_h;
+/* Tasks and ISRs do not print: they write a binary record to the deferred log
+ * (a message ID from this list plus its arguments), which costs well under a
+ * microsecond. The records are formatted by the Log Formatter task or, with
+ * DLOG_HOST_DECODE, read by the host with CMD_READ_LOG and formatted there
+ * with the same table. New messages go at the end of the list. */
+typedef enum
+{
+	eLogUartTransComplete = 0,		// arg 0 = transaction count
+	eLogBaudRateSet,				// arg 0 = baud rate
+	eLogBaudRateFailed,				// arg 0 = baud rate
+	eLogBaudRateFallback,			// arg 0 = baud rate
+	eLogRxOverrun,					// arg 0 = channel (DataSource_t)
+	eLogTxTimeout,					// arg 0 = channel (DataSource_t)
+	eLogBenchRate,					// args = run, round trips/s, bytes/s
+	eLogBenchIsr,					// args = interrupts, average ns, longest ns
+	eLogBenchDrops,					// args = frames lost, Rx bytes/frames dropped, Tx timeouts
+	eNumLogIds
+} LogId_t;
+
+#if !DLOG_HOST_DECODE
+static const char * const pcLogFormats[eNumLogIds] =
+{
+	[eLogUartTransComplete]	= "*** UART transaction complete (count = %u) ***",
+	[eLogBaudRateSet]		= "*** UART1 baud rate %u: set ***",
+	[eLogBaudRateFailed]	= "*** UART1 baud rate %u: FAILED ***",
+	[eLogBaudRateFallback]	= "*** Baud rate not confirmed, back to %u ***",
+	[eLogRxOverrun]			= "*** UART%u Rx FIFO overrun ***",
+	[eLogTxTimeout]			= "*** UART%u response not sent in time ***",
+	[eLogBenchRate]			= "BENCH run=%u round_trips/s=%u bytes/s=%u",
+	[eLogBenchIsr]			= "BENCH isr_count=%u isr_avg_ns=%u isr_max_ns=%u",
+	[eLogBenchDrops]		= "BENCH lost=%u rx_dropped=%u tx_timeouts=%u"
+};
+
+#define LOG_FORMATTER_PERIOD_MS		20U		// Log polled this often (no notification cost for writers)
+
+static void vLogFormatterTask( void *pvParameters );
+#endif
 
-static void vCommandHandlerTxTask( void *pvParams);
-static TaskHandle_t txCommandHandler_h;
+/* End Deferred log defs */
+
+
+/* ----------------------- Loopback benchmark --------------------------- */
+
+/* CMD_BENCH_ECHO responses start with this word, so that the bench can tell
+ * them from its own frames when both come back in through the loopback. A
+ * command frame's first word holds cmd/sz and never matches. */
+#define BENCH_RESP_MARK				0xBE0C0DE5U
+
+/* Results of the last benchmark run (see CMD_GET_BENCH_RESULT). */
+typedef struct {
+	uint32_t	ulRuns;
+	uint32_t	ulRoundTripsPerSec;		// Frames sent and their responses received
+	uint32_t	ulBytesPerSec;			// Bytes sent (frames and responses, framing included)
+	uint32_t	ulIsrCount;
+	uint32_t	ulIsrAvgNs;
+	uint32_t	ulIsrMaxNs;
+	uint32_t	ulLost;					// Frames sent with no response
+	uint32_t	ulRxDropped;			// Rx bytes dropped, overruns, discarded/resync frames
+	uint32_t	ulTxTimeouts;
+} BenchResult_s;
+
+static BenchResult_s xBenchResult;
+
+#if UART1_LOOPBACK_BENCH
+#define BENCH_START_DELAY_MS		1000U
+#define BENCH_RUN_MS				5000U
+#define BENCH_PAUSE_MS				1000U
+#define BENCH_FRAMES_IN_FLIGHT		CMD_TX_POOL_SIZE
+#define BENCH_PAYLOAD_WORDS			13U						// Echoed data words per frame (fills a 64-byte frame)
+#define BENCH_RESPONSE_TIMEOUT		pdMS_TO_TICKS(1000U)	// Outstanding frames are lost after this
+
+static void vLoopbackBenchTask( void *pvParameters );
+static TaskHandle_t xLoopbackBenchTask_h;
+static volatile uint32_t ulBenchResponses;		// CMD_BENCH_ECHO responses received
+#endif
 
-static QueueHandle_t xCmdHandlerRxQueue;
-static QueueHandle_t xCmdHandlerTxQueue;
+/* End Loopback benchmark defs */
+
+
+
+/* ------------------------- Timer task timing --------------------------- */
+
+/* All times are measured from the TTC event (the ideal release time), which
+ * is worked out from the TTC counter when the interrupt is taken:
+ *   eTimingIrqLatency	TTC event -> interrupt handler (release callback) entry
+ *   eTimingIsrExit		TTC event -> interrupt handler exit
+ *   eTimingRelease		TTC event -> task running (release jitter)
+ *   eTimingResponse		TTC event -> task done (response time) */
+typedef enum {
+	eTimingIrqLatency = 0,
+	eTimingIsrExit,
+	eTimingRelease,
+	eTimingResponse,
+	eTimingMetricCount
+} TimingMetric_t;
+
+#define TIMING_TASK1				0U		// vPeriodicTimerTask1
+#define TIMING_TASK2				1U		// vPeriodicTimerTask2
+#define TIMING_TASK_COUNT			2U
+
+#if TIMER_TASK_TIMING
+#define TIMING_ISR_BUCKET_NS		50U		// Histogram range 3.2us
+#define TIMING_TASK_BUCKET_NS		250U	// Histogram range 16us
+
+typedef struct {
+	/* Written by the interrupt handler. */
+	volatile XTime		xIsrEntry;
+	volatile XTime		xIsrExit;
+	volatile uint32_t	ulLatencyNs;		// TTC event -> xIsrEntry
+	/* Task side: copy of the release being handled, and the histograms. */
+	XTime				xEntry;
+	XTime				xExit;
+	XTime				xWake;
+	uint32_t			ulLatency;
+	TimingHist_s		xHist[eTimingMetricCount];
+} TaskTiming_s;
+
+static TaskTiming_s xTaskTiming[TIMING_TASK_COUNT];
+
+static void vTimingInit(void);
+static void vTimingIsrEntry(TaskTiming_s *pxTiming, uint32_t ulLatencyNs);
+static void vTimingIsrExit(TaskTiming_s *pxTiming);
+static void vTimingTaskWoken(TaskTiming_s *pxTiming);
+static void vTimingTaskDone(TaskTiming_s *pxTiming);
+
+#define TIMING_ISR_ENTRY(task, latency_ns)	vTimingIsrEntry(&xTaskTiming[(task)], (latency_ns))
+#define TIMING_ISR_EXIT(task)				vTimingIsrExit(&xTaskTiming[(task)])
+#define TIMING_TASK_WOKEN(task)				vTimingTaskWoken(&xTaskTiming[(task)])
+#define TIMING_TASK_DONE(task)				vTimingTaskDone(&xTaskTiming[(task)])
+#else
+#define TIMING_ISR_ENTRY(task, latency_ns)
+#define TIMING_ISR_EXIT(task)
+#define TIMING_TASK_WOKEN(task)
+#define TIMING_TASK_DONE(task)
+#endif
 
+/* End Timer task timing defs */
 
-/* Definitions for packets that are sent on the command handler queues. */
 
-#define UART_RX_BUFFER_SIZE			64U		// 64 byte command frame from host
-#define UART_TX_BUFFER_SIZE			64U		// 64 byte response frame to host
+/* ------------ Command channels, worker tasks, Tx queues and packet pools -------------- */
 
+/* Each UART is a command channel with its own receive path (Rx ring and Rx
+ * task), command handler instance and transmit path (packet pool, Tx queue and
+ * Tx task). The frames of all channels are executed by a shared set of worker
+ * tasks, and each response goes back to the channel (data source) the frame came
+ * from. A channel has one frame in progress at a time, so its responses stay in
+ * order, while a slow command on one channel (e.g. POLL_UNTIL or a large DMA
+ * transfer) does not hold up the other. */
 typedef enum
 {
-	eUART0 = 0, eUART1,	eCmdHandler
+	eUART0 = 0, eUART1, eNumCmdChannels
 } DataSource_t;
 
-typedef struct
-{
-	uint8_t 		RxBuffer[UART_RX_BUFFER_SIZE];
-	DataSource_t	eDataSource;
-} CmdHandlerRxPkt_s;
+#define CMD_WORKER_COUNT			2U		// More workers than channels never helps
+
+
+/* The UART ISR writes the received bytes straight into a lock-free byte ring
+ * (one producer, the ISR; one consumer, the Rx task) and notifies the Rx task.
+ * The Rx task assembles the byte stream into frames: one 64-byte block, or
+ * (long frames) the number of bytes given by ulCmdHandlerFrameWireSize(). The
+ * ring holds two of the largest frames, so a burst of commands is buffered
+ * while a worker executes the first one. */
+#define UART_RX_BUFFER_SIZE			CMD_FRAME_SIZE				// 64 byte block from host (block mode)
+
+#define CMD_RX_RING_SIZE			(2U * CMD_LONG_FRAME_MAX_SIZE)	// Power of two
+#define CMD_RX_BLOCK_TIMEOUT		pdMS_TO_TICKS( DELAY_100_MSEC )	// Max gap between the bytes of a frame
+
+/* With COBS framing the Rx task decodes the ring contents into the frame buffer
+ * as they arrive, and a frame ends at its delimiter. A frame that ends in the
+ * middle of a COBS block or is too long is dropped, and counted as a resync.
+ *
+ * Responses are built in packets from the channel's pool (see pkt_pool.h). The
+ * worker takes a free packet, the command handler writes the response into it,
+ * and only the packet handle goes on the Tx queue; the Tx task returns the packet
+ * to the pool once the UART reports it has been sent (XUARTPS_EVENT_SENT_DATA).
+ * With two packets the transmit is double-buffered: the next response is built
+ * in one packet while the other drains to the host. Each packet holds the largest
+ * response frame and is cache-line aligned, as CMD_DMA_READ lets the DMA write
+ * into it. The response is built after the packet's headroom, so that it can be
+ * COBS-encoded in place. */
+#define CMD_TX_POOL_SIZE			2U		// Response packets per channel
+
+/* The Tx task waits for the SENT_DATA event for twice the time the response
+ * takes on the wire at the channel's current baud rate (10 bits per byte),
+ * plus CMD_TX_DONE_MARGIN_MS: a 4 KB response takes ~360 ms at 115200 baud,
+ * but ~4.3 s at 9600. */
+#define CMD_TX_DONE_MARGIN_MS		100U
+#define CMD_TX_BITS_PER_BYTE		10U		// Start, 8 data, stop
 
 typedef struct
 {
-	uint8_t 		TxBuffer[UART_TX_BUFFER_SIZE];
-	DataSource_t	eDataSource;
-} CmdHandlerTxPkt_s;
+	/* Receive path */
+	ByteRing_s			xRxRing;					// Written by the UART ISR, read by the Rx task
+	uint8_t				ucRxRingBuffer[CMD_RX_RING_SIZE];
+	uint8_t				ucRxScratch[UART_RX_BUFFER_SIZE];	// Bytes that cannot go in the ring
+	uint8_t				ucRxFrameBuffer[CMD_LONG_FRAME_MAX_SIZE];
+	CobsDecoder_s		xCobsDecoder;				// COBS framing: decodes into ucRxFrameBuffer
+	uint32_t			ulRxFrameLength;			// Bytes in ucRxFrameBuffer, for the worker
+	XTime				xRxFrameTime;				// When the frame was complete
+	CmdHandlerCtx_s		xCmdCtx;					// Command handler instance
+	SemaphoreHandle_t	xFrameDoneSemaphore;		// Given by the worker when it is done with the frame
+	TaskHandle_t		xRxTask_h;
+
+	/* Transmit path */
+	PktPool_s			xTxPool;
+	Pkt_s				xTxPackets[CMD_TX_POOL_SIZE];
+	QueueHandle_t		xTxQueue;					// Response packets, in order
+	TaskHandle_t		xTxTask_h;
+	volatile XTime		xTxDoneTime;				// Set by the UART ISR on XUARTPS_EVENT_SENT_DATA
+
+	/* Receive error counters (see CMD_GET_RX_STATS). */
+	volatile uint32_t	ulRxOverrunCount;			// RX FIFO overruns reported by the UART
+	volatile uint32_t	ulRxDroppedBytes;			// Bytes lost because the Rx ring was full
+	volatile uint32_t	ulRxDiscardCount;			// Incomplete frames discarded by the Rx task
+	volatile uint32_t	ulRxResyncCount;			// COBS frames dropped at a delimiter
+
+	/* Transmit counters (see CMD_GET_TX_STATS). */
+	volatile uint32_t	ulTxFrameCount;				// Responses sent
+	volatile uint32_t	ulTxByteCount;				// Bytes sent, framing included
+	volatile uint32_t	ulTxTimeoutCount;			// Responses with no SENT_DATA event in time
+	volatile uint32_t	ulTxLatencyLast;			// Frame received to response sent, in us
+	volatile uint32_t	ulTxLatencyMax;
+
+	/* UART interrupt handler time (see CMD_GET_ISR_STATS), global timer counts. */
+	volatile uint32_t	ulIsrCount;
+	volatile uint32_t	ulIsrTimeLast;
+	volatile uint32_t	ulIsrTimeMax;
+	volatile uint32_t	ulIsrTimeTotal;				// Wraps; differences are valid
+
+	DataSource_t		eDataSource;
+	XUartPs				*pxUart;					// Driver instance; NULL => channel not in use
+	uint8_t				ucRxStreaming;				// 0 = block mode (see UART1_RX_STREAMING)
+	uint8_t				ucFraming;					// CMD_FRAMING_RAW or CMD_FRAMING_COBS
+	uint32_t			ulRxTriggerLevel;			// Bytes in the RX FIFO when RXOVR fires
+	uint32_t			ulTxBaudPending;			// Set by CMD_SET_BAUD_RATE, moved to its response packet
+} CmdChannel_s;
+
+static CmdChannel_s xCmdChannels[eNumCmdChannels];
+
+static int xCmdChannelStart( DataSource_t eDataSource, XUartPs *pxUart, uint8_t ucRxStreaming, uint8_t ucFraming );
+static void vCmdChannelFree( CmdChannel_s *pxChan );
+static CmdChannel_s *pxCmdChannelFromUart( const XUartPs *pxUart );
+static CmdChannel_s *pxCmdChannelFromFrame( const cmd_frame *p_frame );
+static void vCmdPacketFinish( const CmdChannel_s *pxChan, Pkt_s *pxPkt, uint32_t ulLength );
+static TickType_t xCmdTxDoneTimeout( const CmdChannel_s *pxChan, uint32_t ulLength );
+static void vCmdChannelTxAbort( CmdChannel_s *pxChan );
+#if UART1_LOOPBACK_BENCH
+static void vBenchSendFrame( CmdChannel_s *pxChan, uint32_t ulSeq );
+#endif
+
+static void vCommandHandlerRxTask( void *pvParams);
+static void vCommandHandlerTxTask( void *pvParams);
+static void vCommandWorkerTask( void *pvParams);
+
+static void vCommandHandlerRxCobs( CmdChannel_s *pxChan );
+static void vCommandHandlerRxFrame( CmdChannel_s *pxChan, uint32_t ulRxLength );
+
+// Frames waiting for a worker: one channel pointer per frame.
+static QueueHandle_t xCmdWorkQueue;
 
-// Create the packets:
-static CmdHandlerRxPkt_s CmdHandlerUart1RxPkt   = { .RxBuffer = {0}, .eDataSource = eUART1 };
-static CmdHandlerTxPkt_s CmdHandlerUart1TxPkt   = { .TxBuffer = {0}, .eDataSource = eCmdHandler };
+/* Baud rate negotiation (see CMD_SET_BAUD_RATE). The new rate travels with the
+ * acknowledgement packet (Pkt_s.ulAction) and is applied by the UART1 Tx task
+ * once that packet has been sent, and the probe timer is started.
+ * The host switches after it has received the acknowledgement, then sends
+ * CMD_CONFIRM_BAUD_RATE at the new rate. If that does not arrive before the
+ * timer expires, the timer callback goes back to the previous rate. A host that
+ * gets no reply to its probe goes back too, after the same window. UART1 only. */
+#define CMD_BAUD_PROBE_WINDOW_MS		500U		// Default probe window
+#define CMD_BAUD_PROBE_MAX_WINDOW_MS	10000U
+
+static void vBaudProbeTimerCallback( TimerHandle_t xTimer );
+static int xUart1ChangeBaudRate( uint32_t ulBaudRate );
+
+static TimerHandle_t xBaudProbeTimer;
+static volatile TickType_t xUart1BaudProbeWindow;
+static volatile uint32_t ulUart1BaudFallback = 0;		// Rate to go back to (0 = no probe in progress)
+static volatile uint32_t ulUart1BaudFallbackCount = 0;	// Probes that timed out
 
 /* End Command Handler Tasks defs */
 
 
 
+/* ------------ Application commands -------------- */
+/* Added to the command handler's command table at start-up. */
+
+#define CMD_GET_UART_TRANS_COUNT		0x00E0U		// Returns the UART transaction count
+#define CMD_DMA_COPY					0x00E1U		// DMA copy between memory regions
+#define CMD_DMA_FILL					0x00E2U		// DMA fill of a memory region
+#define CMD_DMA_READ					0x00E3U		// DMA read of a memory region (READ_SEQUENTIAL via DMA)
+#define CMD_GET_CRC_ERROR_COUNT			0x00E4U		// Returns the number of frames with a bad CRC
+#define CMD_GET_RX_STATS				0x00E5U		// Returns the channel's receive error counters
+#define CMD_GET_TX_STATS				0x00E6U		// Returns the channel's transmit counters and latency
+#define CMD_SET_BAUD_RATE				0x00E7U		// Switches UART1 to a new baud rate, pending a probe
+#define CMD_CONFIRM_BAUD_RATE			0x00E8U		// Probe at the new rate; keeps the new rate
+#define CMD_READ_LOG					0x00E9U		// Reads (and removes) deferred log records
+#define CMD_GET_ISR_STATS				0x00EAU		// Returns the channel's UART interrupt handler time
+#define CMD_BENCH_ECHO					0x00EBU		// Echoes its data words (benchmark traffic)
+#define CMD_GET_BENCH_RESULT			0x00ECU		// Returns the last loopback benchmark result
+#define CMD_GET_TIMING_STATS			0x00EDU		// Returns a timer task timing summary (min/mean/max/percentiles)
+#define CMD_GET_TIMING_HIST				0x00EEU		// Returns a timer task timing histogram
+#define CMD_GET_TASK_RUN_TIME			0x00EFU		// Returns the run time (CPU time) of each task
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+#define CMD_RUN_TIME_MAX_TASKS			24U			// Tasks CMD_GET_TASK_RUN_TIME can report
+#define CMD_RUN_TIME_HDR_WORDS			4U
+#define CMD_RUN_TIME_TASK_WORDS			7U			// Number, run time hi/lo, 16 name characters
+#endif
+
+static uint32_t cmdGetUartTransCount(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdDmaCopy(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdDmaFill(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdDmaRead(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGetCrcErrorCount(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGetRxStats(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGetTxStats(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdSetBaudRate(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdConfirmBaudRate(const cmd_frame *p_frame, uint8_t *tx_data);
+#if DLOG_HOST_DECODE
+static uint32_t cmdReadLog(const cmd_frame *p_frame, uint8_t *tx_data);
+#endif
+static uint32_t cmdGetIsrStats(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdBenchEcho(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGetBenchResult(const cmd_frame *p_frame, uint8_t *tx_data);
+#if TIMER_TASK_TIMING
+static uint32_t cmdGetTimingStats(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGetTimingHist(const cmd_frame *p_frame, uint8_t *tx_data);
+#endif
+#if (configGENERATE_RUN_TIME_STATS == 1)
+static uint32_t cmdGetTaskRunTime(const cmd_frame *p_frame, uint8_t *tx_data);
+
+/* Snapshot filled by cmdGetTaskRunTime (too large for the command task's stack).
+ * Shared by the command workers: held under xRunTimeStatusMutex from the
+ * snapshot until the response is written. */
+static TaskStatus_t xRunTimeStatus[CMD_RUN_TIME_MAX_TASKS];
+static SemaphoreHandle_t xRunTimeStatusMutex;
+#endif
+
+/* Updated by vUartCommsDoneNotifiedTask; read by cmdGetUartTransCount. */
+static volatile uint32_t ulUartTransactionCount = 0;
+
+/* End Application commands defs */
+
+
+
 
 
 /*****************************************************************************/
@@ -142,9 +484,17 @@ static CmdHandlerTxPkt_s CmdHandlerUart1TxPkt   = { .TxBuffer = {0}, .eDataSourc
 /*****************************************************************************/
 
 extern XScuGic xInterruptController;
+#if UART0_CMD_CHANNEL
+static XUartPs xUartPs0Inst;
+#endif
 static XUartPs xUartPs1Inst;
 static XTtcPs xTtc0_0_Inst;
+#if TTC_MATCH_SERVICE
+static TtcMatchService_s xTtcMatchService;
+#else
 static XTtcPs xTtc0_1_Inst;
+#endif
+static XDmaPs xDmaPsInst;
 // Note: GPIO driver instances are created at lower level.
 
 
@@ -155,11 +505,18 @@ static XTtcPs xTtc0_1_Inst;
 
 void vLowLevelSysInit(void);
 void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_data);
-void vTtc0_0_IntrHandler(void*);
-void vTtc0_1_IntrHandler(void*);
-
-/* Defined in cmd_handler code. Used in Command Handler Rx task. */
-extern void handleCommand64B(uint8_t *rx_buffer, uint8_t *tx_buffer);
+void vUartCmdIntrHandler(void *CallBackRef);
+#if UART_CMD_FAST_ISR
+static void vUartFastIntrHandler(CmdChannel_s *pxChan, BaseType_t *pxHigherPriorityTaskWoken);
+#endif
+static void vCmdChannelTxDoneFromISR(CmdChannel_s *pxChan, BaseType_t *pxHigherPriorityTaskWoken);
+#if TTC_MATCH_SERVICE
+static void vPeriodicTimerTask1Release(void *pvArg);
+static void vPeriodicTimerTask2Release(void *pvArg);
+#else
+static uint32_t ulTtc0_0_IntrAck(void *pvDevice);
+static uint32_t ulTtc0_1_IntrAck(void *pvDevice);
+#endif
 
 
 
@@ -178,10 +535,47 @@ int main( void )
 	/* Low-level init: SCUGIC, UART, all GPIOs -------------*/
 	/* ---------------------------------------------------- */
 
+	vDlogInit();	// Before any interrupt can write a record
+
 	vLowLevelSysInit();
 
 
 
+	/* ---------------------------------------------------- */
+	/* ------ Add application commands to the handler. ---- */
+	/* ---------------------------------------------------- */
+
+	vCmdHandlerInit();
+
+	xCmdHandlerRegister(CMD_GET_UART_TRANS_COUNT, 0U, 0xFFFFU, CMD_FLAG_BATCHABLE, cmdGetUartTransCount);
+	xCmdHandlerRegister(CMD_DMA_COPY, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED, cmdDmaCopy);
+	xCmdHandlerRegister(CMD_DMA_FILL, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED, cmdDmaFill);
+	xCmdHandlerRegister(CMD_DMA_READ, 1U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED | CMD_FLAG_SZ_RESP, cmdDmaRead);
+	xCmdHandlerRegister(CMD_GET_CRC_ERROR_COUNT, 0U, 0xFFFFU, CMD_FLAG_BATCHABLE, cmdGetCrcErrorCount);
+	xCmdHandlerRegister(CMD_GET_RX_STATS, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdGetRxStats);
+	xCmdHandlerRegister(CMD_GET_TX_STATS, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdGetTxStats);
+	xCmdHandlerRegister(CMD_SET_BAUD_RATE, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdSetBaudRate);
+	xCmdHandlerRegister(CMD_CONFIRM_BAUD_RATE, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdConfirmBaudRate);
+#if DLOG_HOST_DECODE
+	xCmdHandlerRegister(CMD_READ_LOG, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdReadLog);
+#endif
+	xCmdHandlerRegister(CMD_GET_ISR_STATS, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdGetIsrStats);
+	xCmdHandlerRegister(CMD_BENCH_ECHO, 0U, 0xFFFFU, CMD_FLAG_SZ_DATA, cmdBenchEcho);
+	xCmdHandlerRegister(CMD_GET_BENCH_RESULT, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdGetBenchResult);
+#if TIMER_TASK_TIMING
+	xCmdHandlerRegister(CMD_GET_TIMING_STATS, 0U, TIMING_TASK_COUNT - 1U, CMD_FLAG_NONE, cmdGetTimingStats);
+	xCmdHandlerRegister(CMD_GET_TIMING_HIST, 0U, TIMING_TASK_COUNT - 1U, CMD_FLAG_NONE, cmdGetTimingHist);
+#endif
+#if (configGENERATE_RUN_TIME_STATS == 1)
+	xRunTimeStatusMutex = xSemaphoreCreateMutex();
+	if (xRunTimeStatusMutex != NULL)
+	{
+		xCmdHandlerRegister(CMD_GET_TASK_RUN_TIME, 0U, CMD_RUN_TIME_MAX_TASKS - 1U, CMD_FLAG_NONE, cmdGetTaskRunTime);
+	}
+#endif
+
+
+
 	/* ---------------------------------------------------- */
 	/* ------ Create the tasks/semaphores/queues. --------- */
 	/* ---------------------------------------------------- */
@@ -192,7 +586,28 @@ int main( void )
 				configMINIMAL_STACK_SIZE,
 				NULL,
 				tskIDLE_PRIORITY + NOTIFIED_TASK1_PRI,
+				&xUartCommsDoneTask_h );
+
+
+
+#if !DLOG_HOST_DECODE
+	/* -------------------- Log Formatter Task ----------------------- */
+	xTaskCreate( vLogFormatterTask,
+				(const char*) "Log Formatter",
+				configMINIMAL_STACK_SIZE,
+				NULL,
+				tskIDLE_PRIORITY + LOG_FORMATTER_TASK_PRI,
 				NULL );
+#endif
+
+
+
+	/* One-shot timer for the baud rate probe window. The period is set when the timer is started. */
+	xBaudProbeTimer = xTimerCreate( "Baud Probe",
+									pdMS_TO_TICKS( CMD_BAUD_PROBE_WINDOW_MS ),
+									pdFALSE,
+									NULL,
+									vBaudProbeTimerCallback );
 
 
 
@@ -206,75 +621,73 @@ int main( void )
 
 
 
-	/* Timer Task 1 is a HW timer-based task that waits on a semaphore. The semaphore
-	 *  is generated by TTC0-0 every time an interval interrupt occurs. */
-
-	xPeriodTimerTask1Semaphore = xSemaphoreCreateBinary();
+#if TIMER_TASK_TIMING
+	vTimingInit();
+#endif
 
-	if (xPeriodTimerTask1Semaphore != NULL)
-	{
-		xTaskCreate( vPeriodicTimerTask1,
-					(const char*) "Periodic Timer Task 1",
-					configMINIMAL_STACK_SIZE,
-					NULL,
-					tskIDLE_PRIORITY + TIMER_TASK1_PRI,
-					&PeriodTimerTask1_handle
-					);
-	}
+	/* Timer Tasks 1 and 2 are HW timer-based deferred interrupt handlers, woken by
+	 * a task notification from the TTC0-0 (Task 1) and TTC0-1 (Task 2) interrupts,
+	 * or from the two TTC0-0 match events with TTC_MATCH_SERVICE. */
+	xDeferredIrqCreate( &xPeriodTimerTask1Irq,
+						(const char*) "Periodic Timer Task 1",
+						tskIDLE_PRIORITY + TIMER_TASK1_PRI,
+						vPeriodicTimerTask1,
+						NULL );
 
+	xDeferredIrqCreate( &xPeriodTimerTask2Irq,
+						(const char*) "Periodic Timer Task 2",
+						tskIDLE_PRIORITY + TIMER_TASK2_PRI,
+						vPeriodicTimerTask2,
+						NULL );
 
 
-	/* Timer Task 2 is a HW timer-based task that waits on a semaphore. The semaphore
-	 *  is generated by TTC0-01 every time an interval interrupt occurs. */
 
-	xPeriodTimerTask2Semaphore = xSemaphoreCreateBinary();
+	/* Command channels. Each channel has an Rx ring and task, and a Tx queue and task (see xCmdChannelStart).
+	 * The tasks have higher priority than Task 1 so that they can preempt Task 1 to receive and send UART data
+	 * as soon as the HW interrupt occurs or a response is ready. But they have lower priority than the HW timer
+	 * tasks so that they do not affect the HW-timing. */
+	xCmdWorkQueue = xQueueCreate( eNumCmdChannels, sizeof(CmdChannel_s *) );
 
-	if (xPeriodTimerTask2Semaphore != NULL)
-	{
-		xTaskCreate( vPeriodicTimerTask2,
-					(const char*) "Periodic Timer Task 2",
-					configMINIMAL_STACK_SIZE,
-					NULL,
-					tskIDLE_PRIORITY + TIMER_TASK2_PRI,
-					&PeriodTimerTask2_handle
-					);
+	if (xCmdWorkQueue == NULL) {
+		printf("Command work queue not created: no command channels.\n\r");
+	}
+	else {
+		if (xCmdChannelStart(eUART1, &xUartPs1Inst, UART1_RX_STREAMING, UART1_CMD_FRAMING) != XST_SUCCESS) {
+			printf("Command channel UART1 failed to start.\n\r");
+		}
+#if UART0_CMD_CHANNEL
+		if (xCmdChannelStart(eUART0, &xUartPs0Inst, 1U, UART0_CMD_FRAMING) != XST_SUCCESS) {
+			/* Safe on the console (UART0): the channel is not running, so no frame is corrupted. */
+			printf("Command channel UART0 failed to start.\n\r");
+		}
+#endif
 	}
 
 
 
-	/* Command handler Rx Queue and Task. the task waits on queue data sent by the PS7 UART interrupt handler.
-	 * The queue data is of type CmdHandlerUart1RxPkt;  A single-element queue is used, and the packet contains
-	 * a 64-byte buffer of data received by the UART. The task has higher priority than Task 1 so that it can
-	 * preempt Task 1 to receive UART data as soon as the HW interrupt occurs. But it has lower priority than
-	 * the HW timer tasks so that it does not affect the HW-timing. */
-	xCmdHandlerRxQueue = xQueueCreate( 1, sizeof(CmdHandlerRxPkt_s) );
-
-	if(xCmdHandlerRxQueue != NULL) {
-		xTaskCreate( vCommandHandlerRxTask,
-					(const char*) "Command Handler Rx",
-					configMINIMAL_STACK_SIZE,
-					NULL,
-					tskIDLE_PRIORITY + CMDHANDLE_RX_TASK_PRI,
-					&rxCommandHandler_h	);
-	}
-
+#if UART1_LOOPBACK_BENCH
+	/* Loopback benchmark: UART1 transmits into its own receiver. */
+	XUartPs_SetOperMode(&xUartPs1Inst, XUARTPS_OPER_MODE_LOCAL_LOOP);
 
+	xTaskCreate( vLoopbackBenchTask,
+				(const char*) "Loopback Bench",
+				configMINIMAL_STACK_SIZE,
+				NULL,
+				tskIDLE_PRIORITY + LOOPBACK_BENCH_TASK_PRI,
+				&xLoopbackBenchTask_h );
+#endif
 
 
-	/* Command handler Tx Queue and Task. The task waits on queue data sent by Timer Task 2 (just defined above).
-	 * The queue data is of type CmdHandlerUart1TxPkt;  A single-element queue is used, and the packet contains
-	 * a 64-byte buffer of data to be transmitted by the UART back to the host software. The task has higher priority
-	 * than Task 1 so that it can preempt Task 1 to send UART data as soon as the packet arrives. But it has lower
-	 * priority than the HW timer tasks so that it does not affect the HW-timing. */
-	xCmdHandlerTxQueue = xQueueCreate( 1, sizeof(CmdHandlerTxPkt_s) );
 
-	if(xCmdHandlerTxQueue != NULL) {
-		xTaskCreate( vCommandHandlerTxTask,
-					(const char*) "Command Handler Tx",
+	/* Command workers. Each worker waits on the work queue, executes the frame of the channel it receives and
+	 * passes the response to that channel's Tx task. Same priority as the channel tasks. */
+	for (uint32_t ulWorker = 0U; (xCmdWorkQueue != NULL) && (ulWorker < CMD_WORKER_COUNT); ulWorker++) {
+		xTaskCreate( vCommandWorkerTask,
+					(const char*) "Command Worker",
 					configMINIMAL_STACK_SIZE,
 					NULL,
-					tskIDLE_PRIORITY + CMDHANDLE_TX_TASK_PRI,
-					&txCommandHandler_h	);
+					tskIDLE_PRIORITY + CMDHANDLE_WORKER_TASK_PRI,
+					NULL );
 	}
 
 
@@ -286,9 +699,13 @@ int main( void )
 
 
 
-	/* We can start the two HW timers at this point. */
+	/* We can start the HW timers at this point. */
+#if TTC_MATCH_SERVICE
+	startTtcMatch(&xTtcMatchService);
+#else
 	startTtc(&xTtc0_0_Inst);
 	startTtc(&xTtc0_1_Inst);
+#endif
 
 
 
@@ -315,278 +732,1673 @@ int main( void )
 
 
 /*============================================*/
-/* ================== TASKS ==================*/
+/* ============= COMMAND CHANNELS ============*/
 /*============================================*/
 
 
 /*****************************************************************************
- * Function: BackgroundTask1( void *pvParameters )
+ * Function: xCmdChannelStart()
  *//**
  *
- * @brief	Runs in the background every 10ms. Simply toggles LED 1.
+ * @brief	Sets up the command channel of one UART: Rx ring, command handler
+ * 			instance, Tx packet pool and queue, then creates its Rx and Tx
+ * 			tasks (both get the channel as their parameter). Returns
+ * 			XST_SUCCESS or XST_FAILURE; the UART ISR ignores a channel that
+ * 			failed to start, neither of its tasks is left running and the
+ * 			objects it created are deleted.
  *
 ******************************************************************************/
 
-static void BackgroundTask1( void *pvParameters )
+static int xCmdChannelStart( DataSource_t eDataSource, XUartPs *pxUart, uint8_t ucRxStreaming, uint8_t ucFraming )
 {
 
-	// Keep track of LED count so that we can slow down LED toggle rate:
-	static volatile uint32_t led1_count = 0;
+	CmdChannel_s *pxChan = &xCmdChannels[eDataSource];
 
+	pxChan->eDataSource = eDataSource;
+	pxChan->ucRxStreaming = ucRxStreaming;
+	pxChan->ucFraming = ucFraming;
+	vCmdHandlerCtxInit(&pxChan->xCmdCtx);
 
-	// 10ms task timing
-	TickType_t xPreviousWakeTime = 0;
-	const TickType_t xPeriod = pdMS_TO_TICKS( DELAY_10_MSEC );
+	pxChan->xFrameDoneSemaphore = xSemaphoreCreateBinary();
+	pxChan->xTxQueue = xQueueCreate( CMD_TX_POOL_SIZE, sizeof(Pkt_s *) );
 
-	xPreviousWakeTime = xTaskGetTickCount();
+	if ( (pxChan->xFrameDoneSemaphore == NULL) || (pxChan->xTxQueue == NULL) ||
+		 (xByteRingInit(&pxChan->xRxRing, pxChan->ucRxRingBuffer, CMD_RX_RING_SIZE) != XST_SUCCESS) ||
+		 (xPktPoolInit(&pxChan->xTxPool, pxChan->xTxPackets, CMD_TX_POOL_SIZE) != XST_SUCCESS) )
+	{
+		vCmdChannelFree(pxChan);
+		return XST_FAILURE;
+	}
 
-	while(1)
+	if ( (xTaskCreate( vCommandHandlerRxTask,
+					(eDataSource == eUART0) ? "Command Handler Rx 0" : "Command Handler Rx 1",
+					configMINIMAL_STACK_SIZE,
+					pxChan,
+					tskIDLE_PRIORITY + CMDHANDLE_RX_TASK_PRI,
+					&pxChan->xRxTask_h ) != pdPASS) )
 	{
+		pxChan->xRxTask_h = NULL;
+		vCmdChannelFree(pxChan);
+		return XST_FAILURE;
+	}
 
-		psGpOutToggle(PS_GP_OUT1); // TEST SIGNAL: Toggle to indicate task is entered.
+	if ( (xTaskCreate( vCommandHandlerTxTask,
+					(eDataSource == eUART0) ? "Command Handler Tx 0" : "Command Handler Tx 1",
+					configMINIMAL_STACK_SIZE,
+					pxChan,
+					tskIDLE_PRIORITY + CMDHANDLE_TX_TASK_PRI,
+					&pxChan->xTxTask_h ) != pdPASS) )
+	{
+		/* Do not leave a half-started channel: its Rx task would pass frames
+		 * to workers whose responses nobody sends. */
+		vTaskDelete(pxChan->xRxTask_h);
+		pxChan->xRxTask_h = NULL;
+		pxChan->xTxTask_h = NULL;
+		vCmdChannelFree(pxChan);
+		return XST_FAILURE;
+	}
 
-		// Delay
-		vTaskDelayUntil(&xPreviousWakeTime, xPeriod);
+	pxChan->ulRxTriggerLevel = XUartPs_GetFifoThreshold(pxUart);
 
-		// Toggle LED
-		led1_count++;
-		if (led1_count >= LED1_TOGGLE_COUNT)
-		{
-			axiGp0_OutToggle(LED1);
-			led1_count = 0;
-		}
-	}
+	/* Last: the UART ISR starts using the channel once this is set. */
+	pxChan->pxUart = pxUart;
+
+	return XST_SUCCESS;
 }
 
 
 
 /*****************************************************************************
- * Function: vPeriodicTimerTask1( void *pvParameters )
+ * Function: vCmdChannelFree()
  *//**
  *
- * @brief	Waits (blocks) on a semaphore generated by TTC0-0 every time an
- * 			interval interrupt occurs. Then it toggles LED2 (if count is reached)
- * 			and	returns to the waiting (blocked) state.
+ * @brief	Deletes the semaphore, Tx queue and Tx pool of a channel that
+ * 			failed to start (those that were created). Its tasks must already
+ * 			be deleted, and the UART ISR must not be using it (pxUart NULL).
  *
 ******************************************************************************/
 
-static void vPeriodicTimerTask1 ( void *pvParameters )
+static void vCmdChannelFree( CmdChannel_s *pxChan )
 {
 
-	// Keep track of LED count so that we can slow down LED toggle rate:
-	static volatile uint32_t led2_count = 0;
-
-	while(1)
+	if (pxChan->xFrameDoneSemaphore != NULL)
 	{
+		vSemaphoreDelete(pxChan->xFrameDoneSemaphore);
+		pxChan->xFrameDoneSemaphore = NULL;
+	}
 
-		// Task waits for semaphore at this point.
-		xSemaphoreTake(xPeriodTimerTask1Semaphore, portMAX_DELAY);
+	if (pxChan->xTxQueue != NULL)
+	{
+		vQueueDelete(pxChan->xTxQueue);
+		pxChan->xTxQueue = NULL;
+	}
 
-		// Semaphore received: task continues.
-		axiGp0_OutSet(PMOD_JE_1);	/// TEST SIGNAL: task unblocked
+	vPktPoolDelete(&pxChan->xTxPool);
+}
 
 
-		// Toggle LED
-		led2_count++;
 
-		if (led2_count >= LED2_TOGGLE_COUNT)
-		{
-			axiGp0_OutToggle(LED2);
-			led2_count = 0;
-		}
+/*****************************************************************************
+ * Function: xCmdTxDoneTimeout()
+ *//**
+ *
+ * @brief	How long the Tx task waits for a response of ulLength bytes to be
+ * 			sent: twice its time on the wire at the channel's current baud
+ * 			rate, plus CMD_TX_DONE_MARGIN_MS.
+ *
+******************************************************************************/
 
+static TickType_t xCmdTxDoneTimeout( const CmdChannel_s *pxChan, uint32_t ulLength )
+{
+	uint32_t ulBaudRate = pxChan->pxUart->BaudRate;
+	uint32_t ulWireMs;
 
-		// Dummy delay so that GPIO signal can be clearly seen on scope.
-		for (int i = 100; i >=0; i--) {}
+	if (ulBaudRate == 0U)
+	{
+		ulBaudRate = UART1_BAUD_RATE_MIN;
+	}
 
-		axiGp0_OutClear(PMOD_JE_1);	/// TEST SIGNAL: task blocked again
+	ulWireMs = ((ulLength * CMD_TX_BITS_PER_BYTE * 1000U) + ulBaudRate - 1U) / ulBaudRate;
 
-	}
+	return pdMS_TO_TICKS( (2U * ulWireMs) + CMD_TX_DONE_MARGIN_MS );
 }
 
 
+
 /*****************************************************************************
- * Function: vPeriodicTimerTask1( void *pvParameters )
+ * Function: vCmdChannelTxAbort()
  *//**
  *
- * @brief	Waits (blocks) on a semaphore generated by TTC0-1 every time an
- * 			interval interrupt occurs. Then it toggles LED3 (if count is reached)
- * 			and	returns to the waiting (blocked) state.
+ * @brief	Stops a response that was not reported as sent in time: disables
+ * 			the TX interrupts, drops what is left of it in the driver and the
+ * 			TX FIFO, then clears any SENT_DATA notification that came in on
+ * 			the way, so that it is not taken for the next response. After
+ * 			this the ISR no longer reads the packet, which can go back to
+ * 			the pool.
  *
 ******************************************************************************/
 
-static void vPeriodicTimerTask2 ( void *pvParameters )
+static void vCmdChannelTxAbort( CmdChannel_s *pxChan )
 {
+	XUartPs *pxUart = pxChan->pxUart;
+	UINTPTR base = pxUart->Config.BaseAddress;
+
+	/* The UART interrupt is masked in here, so the ISR is not half way
+	 * through the send buffer. */
+	taskENTER_CRITICAL();
+	XUartPs_WriteReg(base, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY | XUARTPS_IXR_TXFULL);
+	pxUart->SendBuffer.RemainingBytes = 0U;
+	pxUart->SendBuffer.NextBytePtr = NULL;
+	XUartPs_WriteReg(base, XUARTPS_CR_OFFSET,
+					 XUartPs_ReadReg(base, XUARTPS_CR_OFFSET) | XUARTPS_CR_TXRST);
+	taskEXIT_CRITICAL();
+
+	(void)ulTaskNotifyValueClear(NULL, 0xFFFFFFFFU);
+}
 
-	// Keep track of LED count so that we can slow down LED toggle rate:
-	static volatile uint32_t led3_count = 0;
-
-	while(1)
-	{
-
-		// Task waits for semaphore at this point.
-		xSemaphoreTake(xPeriodTimerTask2Semaphore, portMAX_DELAY);
 
-		// Semaphore received: task continues.
-		axiGp0_OutSet(PMOD_JE_2);	// TEST SIGNAL: task unblocked
 
+/*****************************************************************************
+ * Function: pxCmdChannelFromUart() / pxCmdChannelFromFrame()
+ *//**
+ *
+ * @brief	Return the channel of a UART driver instance (the UART ISR's
+ * 			CallBackRef), or of a frame being executed (its command handler
+ * 			instance). NULL if there is none.
+ *
+******************************************************************************/
 
-		// Toggle LED
-		led3_count++;
+static CmdChannel_s *pxCmdChannelFromUart( const XUartPs *pxUart )
+{
+	uint32_t idx;
 
-		if (led3_count >= LED3_TOGGLE_COUNT)
+	for (idx = 0U; idx < eNumCmdChannels; idx++)
+	{
+		if ( (pxUart != NULL) && (xCmdChannels[idx].pxUart == pxUart) )
 		{
-			axiGp0_OutToggle(LED3);
-			led3_count = 0;
+			return &xCmdChannels[idx];
 		}
+	}
 
+	return NULL;
+}
 
-		// Dummy delay so that GPIO signal can be clearly seen on scope.
-		for (int i = 100; i >=0; i--) {}
-
-		axiGp0_OutClear(PMOD_JE_2);	/// TEST SIGNAL: task blocked
+static CmdChannel_s *pxCmdChannelFromFrame( const cmd_frame *p_frame )
+{
+	uint32_t idx;
 
+	for (idx = 0U; idx < eNumCmdChannels; idx++)
+	{
+		if (&xCmdChannels[idx].xCmdCtx == p_frame->p_ctx)
+		{
+			return &xCmdChannels[idx];
+		}
 	}
+
+	return NULL;
 }
 
 
 
 /*****************************************************************************
- * Function: vCommandHandlerRxTask( void *pvParameters )
+ * Function: vCmdPacketFinish()
  *//**
  *
- * @brief	Command handler Receive Task. Waits on a queue packet that is
- * 			generated by the UART interrupt handler when data (64 bytes)
- * 			is received by host software. It calls the command handler
- * 			to execute the command. Then it sends the command handler
- * 			Tx packet to vCommandHandlerTxTask. Finally, it returns to the
- * 			blocked state, waiting for the next packet.
+ * @brief	Frames the ulLength bytes built at PKT_HEADROOM in a Tx packet for
+ * 			the channel: COBS-encodes them in place, or leaves them as they
+ * 			are for raw framing. Sets the packet's offset and length.
  *
 ******************************************************************************/
 
-static void vCommandHandlerRxTask(void *pvParams)
+static void vCmdPacketFinish( const CmdChannel_s *pxChan, Pkt_s *pxPkt, uint32_t ulLength )
 {
-
-	while(1)
+	if (pxChan->ucFraming == CMD_FRAMING_COBS)
 	{
+		pxPkt->ulOffset = 0U;
+		pxPkt->ulLength = ulCobsEncode(&pxPkt->ucBuffer[PKT_HEADROOM], ulLength, pxPkt->ucBuffer);
+	}
+	else
+	{
+		pxPkt->ulOffset = PKT_HEADROOM;
+		pxPkt->ulLength = ulLength;
+	}
+}
 
-		/* Task waits for Queue data at this point. */
-		xQueueReceive(xCmdHandlerRxQueue, CmdHandlerUart1RxPkt.RxBuffer, portMAX_DELAY);
-		//// !!!!! WAITING !!!!!
-
-
-
-		/* Queue element has been received... continue with task: */
-		psGpOutSet(PS_GP_OUT2);	/// TEST SIGNAL: Start of task
+/* --- END COMMAND CHANNELS ---------------------------------------------*/
 
-		/* Call function to handle the data */
-		handleCommand64B(CmdHandlerUart1RxPkt.RxBuffer, CmdHandlerUart1TxPkt.TxBuffer);
 
-		/* Send the Tx packet to the transmit task. */
-		xQueueSend(xCmdHandlerTxQueue, CmdHandlerUart1TxPkt.TxBuffer, portMAX_DELAY);
 
 
-		psGpOutClear(PS_GP_OUT2);	/// TEST SIGNAL: End of task
-	}
-}
+/*============================================*/
+/* ================== TASKS ==================*/
+/*============================================*/
 
 
 /*****************************************************************************
- * Function: vCommandHandlerTxTask( void *pvParameters )
+ * Function: BackgroundTask1( void *pvParameters )
  *//**
  *
- * @brief	Command handler Transmit Task. Waits on a queue packet that is
- * 			generated by the Command handler Receive Task. When the packet is
- * 			received, the task calls the UART function to send the data back to
- * 			the host software. It then returns to the blocked state, waiting
- * 			for the next packet.
+ * @brief	Runs in the background every 10ms. Simply toggles LED 1.
  *
 ******************************************************************************/
 
-static void vCommandHandlerTxTask(void *pvParams)
+static void BackgroundTask1( void *pvParameters )
 {
 
-	const char* pcNameToLookup = "Uart Comms Done Notified Task";
-	TaskHandle_t xTaskToNotify;
+	// Keep track of LED count so that we can slow down LED toggle rate:
+	static volatile uint32_t led1_count = 0;
+
 
-	xTaskToNotify = xTaskGetHandle(pcNameToLookup);
+	// 10ms task timing
+	TickType_t xPreviousWakeTime = 0;
+	const TickType_t xPeriod = pdMS_TO_TICKS( DELAY_10_MSEC );
 
+	xPreviousWakeTime = xTaskGetTickCount();
 
 	while(1)
 	{
 
-		/* Task waits for Queue data at this point. */
-		xQueueReceive(xCmdHandlerTxQueue, CmdHandlerUart1TxPkt.TxBuffer, portMAX_DELAY);
-		//// !!!!! WAITING !!!!!
-
-
-
-		/* Queue element has been received... continue with task: */
-		psGpOutSet(PS_GP_OUT3);	/// TEST SIGNAL: Start of task
-
-		/* === TX TO HOST === */
-		/* Send the response data to the host.
-		 * Note that XUartPs_Send() will enable some TX interrupts. */
-		XUartPs_Send(&xUartPs1Inst, CmdHandlerUart1TxPkt.TxBuffer, UART_TX_BUFFER_SIZE);
-
-
-
-		/* Send the notification to the X task that the UART transaction
-		 * is complete. The notifier is set to increment. */
-		xTaskNotify(xTaskToNotify, 0x0, eIncrement);
+		psGpOutToggle(PS_GP_OUT1); // TEST SIGNAL: Toggle to indicate task is entered.
 
+		// Delay
+		vTaskDelayUntil(&xPreviousWakeTime, xPeriod);
 
-		psGpOutClear(PS_GP_OUT3);	/// TEST SIGNAL: End of task
+		// Toggle LED
+		led1_count++;
+		if (led1_count >= LED1_TOGGLE_COUNT)
+		{
+			axiGp0_OutToggle(LED1);
+			led1_count = 0;
+		}
 	}
 }
 
 
 
 /*****************************************************************************
- * Function: vUartCommsDoneNotifiedTask( void *pvParameters )
+ * Function: vPeriodicTimerTask1( void *pvArg, uint32_t ulEvents, uint32_t ulStatus )
  *//**
  *
- * @brief	Waits on a notifier from vCommandHandlerTxTask; the notifier
- * 			indicates that the UART Rx and Tx phases are complete. The notifier
- * 			is set to increment for every Rx-Tx transaction and is not cleared,
- * 			i.e. it gives a count of the number of UART transactions.
+ * @brief	Deferred interrupt handler of TTC0-0, run in its handler task every
+ * 			time an interval (or, with TTC_MATCH_SERVICE, its first match
+ * 			event) occurs. It toggles LED2 (if count is reached) and returns,
+ * 			and the task waits for the next notification. ulEvents > 1 if
+ * 			releases arrived while the task was still busy: each counts.
  *
 ******************************************************************************/
 
-static void vUartCommsDoneNotifiedTask( void *pvParameters )
+static void vPeriodicTimerTask1 ( void *pvArg, uint32_t ulEvents, uint32_t ulStatus )
 {
 
-	uint32_t pulNotificationValue;
-
-	while(1)
-	{
+	// Keep track of LED count so that we can slow down LED toggle rate:
+	static volatile uint32_t led2_count = 0;
 
-		/* Task waits for notifier at this point. It does not clear the notifier
-		 * at any point (i.e. the first two function parameters are 0), which means
-		 * it will increment*/
-		xTaskNotifyWait(0, 0, &pulNotificationValue, portMAX_DELAY);
-		//// !!!!! WAITING !!!!!
+	(void) pvArg;
+	(void) ulStatus;
 
+	// Notification received: task continues.
+	axiGp0_OutSet(PMOD_JE_1);	/// TEST SIGNAL: task unblocked
+	TIMING_TASK_WOKEN(TIMING_TASK1);
 
-		/* Notifier has been received... continue with task: */
-		psGpOutSet(PS_GP_OUT6);	/// TEST SIGNAL: Start of task
 
-		/* Simply print out the transaction count. */
-		printf("*** UART transaction complete (count = %u) ***\n\r", pulNotificationValue);
+	// Toggle LED
+	led2_count += ulEvents;
 
-		psGpOutClear(PS_GP_OUT6);	/// TEST SIGNAL: End of task
+	if (led2_count >= LED2_TOGGLE_COUNT)
+	{
+		axiGp0_OutToggle(LED2);
+		led2_count = 0;
 	}
-}
-
 
-/* --- END TASKS ---------------------------------------------------------*/
+
+	// Dummy delay so that GPIO signal can be clearly seen on scope.
+	for (int i = 100; i >=0; i--) {}
+
+	TIMING_TASK_DONE(TIMING_TASK1);
+	axiGp0_OutClear(PMOD_JE_1);	/// TEST SIGNAL: task blocked again
+}
+
+
+/*****************************************************************************
+ * Function: vPeriodicTimerTask2( void *pvArg, uint32_t ulEvents, uint32_t ulStatus )
+ *//**
+ *
+ * @brief	Deferred interrupt handler of TTC0-1 (or of the second match event
+ * 			of TTC0-0 with TTC_MATCH_SERVICE). It toggles LED3 (if count is
+ * 			reached) and returns, and the task waits for the next
+ * 			notification.
+ *
+******************************************************************************/
+
+static void vPeriodicTimerTask2 ( void *pvArg, uint32_t ulEvents, uint32_t ulStatus )
+{
+
+	// Keep track of LED count so that we can slow down LED toggle rate:
+	static volatile uint32_t led3_count = 0;
+
+	(void) pvArg;
+	(void) ulStatus;
+
+	// Notification received: task continues.
+	axiGp0_OutSet(PMOD_JE_2);	// TEST SIGNAL: task unblocked
+	TIMING_TASK_WOKEN(TIMING_TASK2);
+
+
+	// Toggle LED
+	led3_count += ulEvents;
+
+	if (led3_count >= LED3_TOGGLE_COUNT)
+	{
+		axiGp0_OutToggle(LED3);
+		led3_count = 0;
+	}
+
+
+	// Dummy delay so that GPIO signal can be clearly seen on scope.
+	for (int i = 100; i >=0; i--) {}
+
+	TIMING_TASK_DONE(TIMING_TASK2);
+	axiGp0_OutClear(PMOD_JE_2);	/// TEST SIGNAL: task blocked
+}
+
+
+
+/*****************************************************************************
+ * Function: vCommandHandlerRxTask( void *pvParameters )
+ *//**
+ *
+ * @brief	Command handler Receive Task, one per channel (pvParameters).
+ * 			Waits on a notification from the UART interrupt handler, given
+ * 			when data from the host software has been written to the
+ * 			channel's Rx ring. The task copies the bytes from
+ * 			the ring into the frame buffer until a whole frame (64 bytes, or
+ * 			the size given in a long frame header) has been received, then
+ * 			calls vCommandHandlerRxFrame() to handle it. The ring may already
+ * 			hold the start of the next frame.
+ *
+ * 			If the bytes of a frame stop arriving, a partial long frame is
+ * 			passed on anyway (the command handler answers it with CMD_ERROR);
+ * 			a partial 64-byte block is discarded, so that the next frame
+ * 			starts at the beginning of the frame buffer.
+ *
+ * 			Channels with COBS framing run vCommandHandlerRxCobs() instead.
+ *
+******************************************************************************/
+
+static void vCommandHandlerRxTask(void *pvParams)
+{
+
+	CmdChannel_s *pxChan = (CmdChannel_s *)pvParams;
+	uint32_t ulRxLength = 0U;					// Bytes of the current frame received so far
+	uint32_t ulFrameSize = CMD_FRAME_SIZE;		// Bytes in the current frame
+	const uint8_t *pucRxData;
+	uint32_t ulCopy;
+
+	if (pxChan->ucFraming == CMD_FRAMING_COBS)
+	{
+		vCommandHandlerRxCobs(pxChan);		// Does not return
+	}
+
+	while(1)
+	{
+
+		/* Task waits for the UART ISR at this point, unless the ring still
+		 * holds data. Once a frame has started, the rest of it must arrive
+		 * within CMD_RX_BLOCK_TIMEOUT. */
+		pucRxData = pucByteRingReadRegion(&pxChan->xRxRing, &ulCopy);
+		if (ulCopy == 0U)
+		{
+			if ( (ulTaskNotifyTake(pdTRUE, (ulRxLength == 0U) ? portMAX_DELAY : CMD_RX_BLOCK_TIMEOUT) == 0U) &&
+				 (ulByteRingUsed(&pxChan->xRxRing) == 0U) )
+			{
+				if (ulRxLength >= CMD_FRAME_SIZE)
+				{
+					vCommandHandlerRxFrame(pxChan, ulRxLength);
+				}
+				else
+				{
+					pxChan->ulRxDiscardCount++;
+				}
+
+				ulRxLength = 0U;
+				ulFrameSize = CMD_FRAME_SIZE;
+			}
+			continue;
+		}
+		//// !!!!! WAITING !!!!!
+
+
+
+		/* Data in the ring... continue with task: */
+		psGpOutSet(PS_GP_OUT2);	/// TEST SIGNAL: Start of task
+
+		if (ulCopy > (ulFrameSize - ulRxLength))
+		{
+			ulCopy = ulFrameSize - ulRxLength;
+		}
+
+		memcpy(&pxChan->ucRxFrameBuffer[ulRxLength], pucRxData, ulCopy);
+		vByteRingConsume(&pxChan->xRxRing, ulCopy);
+		ulRxLength += ulCopy;
+
+		/* First block complete: a long frame header gives the full size. */
+		if (ulRxLength == CMD_FRAME_SIZE)
+		{
+			ulFrameSize = ulCmdHandlerFrameWireSize(&pxChan->xCmdCtx, pxChan->ucRxFrameBuffer);
+		}
+
+		if (ulRxLength == ulFrameSize)
+		{
+			vCommandHandlerRxFrame(pxChan, ulRxLength);
+			ulRxLength = 0U;
+			ulFrameSize = CMD_FRAME_SIZE;
+		}
+
+
+		psGpOutClear(PS_GP_OUT2);	/// TEST SIGNAL: End of task
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vCommandHandlerRxCobs( CmdChannel_s *pxChan )
+ *//**
+ *
+ * @brief	Receive loop of vCommandHandlerRxTask for a channel with COBS
+ * 			framing. Decodes the bytes in the Rx ring into the frame buffer,
+ * 			and calls vCommandHandlerRxFrame() at each delimiter that ends a
+ * 			good frame. No timeout is needed: after a lost, extra or corrupt
+ * 			byte, the frame in progress is dropped at the next delimiter (or
+ * 			fails its length/CRC checks) and the following frame is received
+ * 			normally. Empty frames (repeated delimiters) are ignored, so the
+ * 			host may send a delimiter before each frame to flush the decoder.
+ *
+******************************************************************************/
+
+static void vCommandHandlerRxCobs( CmdChannel_s *pxChan )
+{
+
+	const uint8_t *pucRxData;
+	uint32_t ulCopy;
+	uint32_t ulUsed;
+	uint32_t ulStatus;
+
+	vCobsDecoderReset(&pxChan->xCobsDecoder, pxChan->ucRxFrameBuffer, CMD_LONG_FRAME_MAX_SIZE);
+
+	while(1)
+	{
+
+		/* Task waits for the UART ISR at this point, unless the ring still
+		 * holds data. */
+		pucRxData = pucByteRingReadRegion(&pxChan->xRxRing, &ulCopy);
+		if (ulCopy == 0U)
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			continue;
+		}
+		//// !!!!! WAITING !!!!!
+
+
+
+		/* Data in the ring... continue with task: */
+		psGpOutSet(PS_GP_OUT2);	/// TEST SIGNAL: Start of task
+
+		ulUsed = ulCobsDecode(&pxChan->xCobsDecoder, pucRxData, ulCopy, &ulStatus);
+		vByteRingConsume(&pxChan->xRxRing, ulUsed);
+
+		if (ulStatus != COBS_IN_PROGRESS)
+		{
+			if (ulStatus == COBS_FRAME_BAD)
+			{
+				pxChan->ulRxResyncCount++;
+			}
+			else if (pxChan->xCobsDecoder.ulLength != 0U)
+			{
+				vCommandHandlerRxFrame(pxChan, pxChan->xCobsDecoder.ulLength);
+			}
+
+			vCobsDecoderReset(&pxChan->xCobsDecoder, pxChan->ucRxFrameBuffer, CMD_LONG_FRAME_MAX_SIZE);
+		}
+
+
+		psGpOutClear(PS_GP_OUT2);	/// TEST SIGNAL: End of task
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vCommandHandlerRxFrame( CmdChannel_s *pxChan, uint32_t ulRxLength )
+ *//**
+ *
+ * @brief	Called by vCommandHandlerRxTask when a frame has been received.
+ * 			Passes the channel to a worker and waits until the worker has
+ * 			finished with the frame buffer (i.e. has queued the response),
+ * 			which keeps the responses of the channel in order.
+ *
+******************************************************************************/
+
+static void vCommandHandlerRxFrame( CmdChannel_s *pxChan, uint32_t ulRxLength )
+{
+
+#if UART1_LOOPBACK_BENCH
+	/* Loopback benchmark: the responses come back in as well. Count them,
+	 * and let the bench send the next frame. */
+	if ( (pxChan->eDataSource == eUART1) && (ulRxLength >= 4U) &&
+		 (ulCmdLoadBE32(pxChan->ucRxFrameBuffer) == BENCH_RESP_MARK) )
+	{
+		ulBenchResponses++;
+		xTaskNotifyGive(xLoopbackBenchTask_h);
+		return;
+	}
+#endif
+
+	pxChan->ulRxFrameLength = ulRxLength;
+
+	/* Start of the request-response latency (see CMD_GET_TX_STATS). */
+	XTime_GetTime(&pxChan->xRxFrameTime);
+
+	xQueueSend(xCmdWorkQueue, &pxChan, portMAX_DELAY);
+	xSemaphoreTake(pxChan->xFrameDoneSemaphore, portMAX_DELAY);
+
+}
+
+
+
+/*****************************************************************************
+ * Function: vCommandWorkerTask( void *pvParameters )
+ *//**
+ *
+ * @brief	Command worker task. Waits on the work queue for a channel with
+ * 			a received frame, takes a free packet from the channel's Tx pool,
+ * 			calls the command handler to execute the command and write the
+ * 			response into the packet (COBS-encoding it in place if the
+ * 			channel uses COBS framing), then passes the packet to the
+ * 			channel's Tx task and releases the channel's Rx task.
+ *
+******************************************************************************/
+
+static void vCommandWorkerTask( void *pvParams )
+{
+
+	CmdChannel_s *pxChan;
+	Pkt_s *pxTxPkt;
+	uint32_t ulTxLength;
+
+	while(1)
+	{
+
+		/* Task waits for a frame at this point. */
+		xQueueReceive(xCmdWorkQueue, &pxChan, portMAX_DELAY);
+		//// !!!!! WAITING !!!!!
+
+
+		/* Wait for a response packet (both may still be queued for sending). */
+		pxTxPkt = pxPktPoolGet(&pxChan->xTxPool, portMAX_DELAY);
+		pxTxPkt->ullTimestamp = pxChan->xRxFrameTime;
+
+		/* Call function to handle the data */
+		ulTxLength = ulCmdHandlerProcess(&pxChan->xCmdCtx, pxChan->ucRxFrameBuffer, pxChan->ulRxFrameLength,
+										 &pxTxPkt->ucBuffer[PKT_HEADROOM], PKT_BUFFER_SIZE);
+		vCmdPacketFinish(pxChan, pxTxPkt, ulTxLength);
+
+		/* A baud rate change is applied once this response has been sent. */
+		pxTxPkt->ulAction = pxChan->ulTxBaudPending;
+		pxChan->ulTxBaudPending = 0U;
+
+		/* Queue the response before the next frame of the channel can start. */
+		xQueueSend(pxChan->xTxQueue, &pxTxPkt, portMAX_DELAY);
+		xSemaphoreGive(pxChan->xFrameDoneSemaphore);
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vCommandHandlerTxTask( void *pvParameters )
+ *//**
+ *
+ * @brief	Command handler Transmit Task, one per channel (pvParameters).
+ * 			Waits on a queue packet that is generated by a command worker for
+ * 			the channel. When the packet is
+ * 			received, the task calls the UART function to send the data back to
+ * 			the host software and waits for the UART ISR to notify it that the
+ * 			last byte has left the TX FIFO (XUARTPS_EVENT_SENT_DATA). It then
+ * 			records the latency, returns the packet to the pool, applies the
+ * 			baud rate change carried by the packet (ulAction, only set on a
+ * 			CMD_SET_BAUD_RATE acknowledgement) and waits for the next packet.
+ *
+ * 			The packet stays out of the pool until it has been sent, so a
+ * 			worker can only be building the response in the other packet.
+ *
+******************************************************************************/
+
+static void vCommandHandlerTxTask(void *pvParams)
+{
+
+	CmdChannel_s *pxChan = (CmdChannel_s *)pvParams;
+	Pkt_s *pxTxPkt;
+	uint64_t ullLatency;
+	uint32_t ulBaudRate;
+	BaseType_t xSent;
+
+
+	while(1)
+	{
+
+		/* Task waits for Queue data at this point. */
+		xQueueReceive(pxChan->xTxQueue, &pxTxPkt, portMAX_DELAY);
+		//// !!!!! WAITING !!!!!
+
+
+
+		/* Queue element has been received... continue with task: */
+		psGpOutSet(PS_GP_OUT3);	/// TEST SIGNAL: Start of task
+
+		/* === TX TO HOST === */
+		/* Send the response data to the host.
+		 * Note that XUartPs_Send() will enable some TX interrupts. */
+		XUartPs_Send(pxChan->pxUart, &pxTxPkt->ucBuffer[pxTxPkt->ulOffset], pxTxPkt->ulLength);
+
+		/* Wait for the UART ISR to report that the response has been sent. */
+		xSent = (ulTaskNotifyTake(pdTRUE, xCmdTxDoneTimeout(pxChan, pxTxPkt->ulLength)) != 0U) ? pdTRUE : pdFALSE;
+		if (xSent != pdFALSE)
+		{
+			ullLatency = ((pxChan->xTxDoneTime - pxTxPkt->ullTimestamp) * 1000000ULL) / COUNTS_PER_SECOND;
+			pxChan->ulTxLatencyLast = (uint32_t)ullLatency;
+			if (pxChan->ulTxLatencyLast > pxChan->ulTxLatencyMax)
+			{
+				pxChan->ulTxLatencyMax = pxChan->ulTxLatencyLast;
+			}
+		}
+		else
+		{
+			/* The ISR may still be sending from the packet: stop it before
+			 * the packet goes back to the pool. */
+			vCmdChannelTxAbort(pxChan);
+			pxChan->ulTxTimeoutCount++;
+			DLOG1(eLogTxTimeout, pxChan->eDataSource);
+		}
+		pxChan->ulTxFrameCount++;
+		pxChan->ulTxByteCount += pxTxPkt->ulLength;
+
+		ulBaudRate = pxTxPkt->ulAction;
+		pxTxPkt->ulAction = 0U;
+		vPktPoolPut(&pxChan->xTxPool, pxTxPkt);
+
+		/* CMD_SET_BAUD_RATE has been acknowledged at the old rate: switch
+		 * and give the host the probe window to confirm the new one. If the
+		 * change or the timer fails, go back to the old rate straight away
+		 * (reported as a fallback). If the acknowledgement was not sent,
+		 * the host never saw it: drop the change. */
+		if (ulBaudRate != 0U)
+		{
+			if (xSent != pdFALSE)
+			{
+				if ( (xUart1ChangeBaudRate(ulBaudRate) != XST_SUCCESS) ||
+					 (xTimerChangePeriod(xBaudProbeTimer, xUart1BaudProbeWindow, 0) != pdPASS) )
+				{
+					vBaudProbeTimerCallback(xBaudProbeTimer);
+				}
+			}
+			else
+			{
+				taskENTER_CRITICAL();
+				ulUart1BaudFallback = 0U;
+				taskEXIT_CRITICAL();
+			}
+		}
+
+
+		psGpOutClear(PS_GP_OUT3);	/// TEST SIGNAL: End of task
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vUartCommsDoneNotifiedTask( void *pvParameters )
+ *//**
+ *
+ * @brief	Waits on a notifier from the UART ISR, given on
+ * 			XUARTPS_EVENT_SENT_DATA; the notifier indicates that the UART Rx
+ * 			and Tx phases are complete. The notifier
+ * 			is set to increment for every Rx-Tx transaction and is not cleared,
+ * 			i.e. it gives a count of the number of UART transactions.
+ *
+******************************************************************************/
+
+static void vUartCommsDoneNotifiedTask( void *pvParameters )
+{
+
+	uint32_t pulNotificationValue;
+
+	while(1)
+	{
+
+		/* Task waits for notifier at this point. It does not clear the notifier
+		 * at any point (i.e. the first two function parameters are 0), which means
+		 * it will increment*/
+		xTaskNotifyWait(0, 0, &pulNotificationValue, portMAX_DELAY);
+		//// !!!!! WAITING !!!!!
+
+
+		/* Notifier has been received... continue with task: */
+		psGpOutSet(PS_GP_OUT6);	/// TEST SIGNAL: Start of task
+
+		/* Make the count available to the host (CMD_GET_UART_TRANS_COUNT). */
+		ulUartTransactionCount = pulNotificationValue;
+
+		/* Log the transaction count (printed later, see vLogFormatterTask). */
+		DLOG1(eLogUartTransComplete, pulNotificationValue);
+
+		psGpOutClear(PS_GP_OUT6);	/// TEST SIGNAL: End of task
+	}
+}
+
+
+
+#if !DLOG_HOST_DECODE
+/*****************************************************************************
+ * Function: vLogFormatterTask()
+ *//**
+ *
+ * @brief	Prints the deferred log records on the console, at the lowest
+ * 			priority, so that no other task waits for the console UART.
+ * 			Each line starts with the time the record was written, in
+ * 			microseconds (wraps after about 71 minutes).
+ *
+******************************************************************************/
+
+static void vLogFormatterTask( void *pvParameters )
+{
+
+	DlogRecord_s xRec;
+	uint32_t ulDropped = 0U;
+
+	while(1)
+	{
+
+		vTaskDelay(pdMS_TO_TICKS(LOG_FORMATTER_PERIOD_MS));
+
+		while (ulDlogRead(&xRec) != 0U)
+		{
+			printf("[%10u] ", (uint32_t)(xRec.xTime / (COUNTS_PER_SECOND / 1000000U)));
+			if (xRec.usId < eNumLogIds)
+			{
+				printf(pcLogFormats[xRec.usId], xRec.ulArg[0], xRec.ulArg[1], xRec.ulArg[2], xRec.ulArg[3]);
+			}
+			else
+			{
+				printf("Log ID %u", xRec.usId);
+			}
+			printf("\n\r");
+		}
+
+		if (ulDlogDroppedCount() != ulDropped)
+		{
+			ulDropped = ulDlogDroppedCount();
+			printf("*** Log full: %u records dropped ***\n\r", ulDropped);
+		}
+	}
+}
+#endif
+
+
+/*****************************************************************************
+ * Function: vBaudProbeTimerCallback( TimerHandle_t xTimer )
+ *//**
+ *
+ * @brief	Probe window timer callback. The host has not confirmed the new
+ * 			baud rate, so go back to the previous one.
+ *
+******************************************************************************/
+
+static void vBaudProbeTimerCallback( TimerHandle_t xTimer )
+{
+
+	uint32_t ulFallback;
+
+	taskENTER_CRITICAL();
+	ulFallback = ulUart1BaudFallback;
+	ulUart1BaudFallback = 0U;
+	taskEXIT_CRITICAL();
+
+	if (ulFallback != 0U)
+	{
+		xUart1ChangeBaudRate(ulFallback);
+		ulUart1BaudFallbackCount++;
+		DLOG1(eLogBaudRateFallback, ulFallback);
+	}
+}
+
+
+
+#if UART1_LOOPBACK_BENCH
+/*****************************************************************************
+ * Function: vLoopbackBenchTask()
+ *//**
+ *
+ * @brief	Loopback benchmark (UART1_LOOPBACK_BENCH). Every BENCH_RUN_MS,
+ * 			keeps BENCH_FRAMES_IN_FLIGHT CMD_BENCH_ECHO frames going round
+ * 			UART1 in local loopback mode: each frame is received, executed
+ * 			and its response sent like a host frame, and the response is
+ * 			received in turn, which releases the next frame. At the end of
+ * 			a run the outstanding frames are given BENCH_RESPONSE_TIMEOUT to
+ * 			come back, then the run's figures (round trips and bytes per
+ * 			second, UART interrupt handler time, frames and bytes lost) are
+ * 			stored for CMD_GET_BENCH_RESULT and logged.
+ *
+******************************************************************************/
+
+static void vLoopbackBenchTask( void *pvParameters )
+{
+
+	CmdChannel_s *pxChan = &xCmdChannels[eUART1];
+	BenchResult_s xResult = { 0 };
+	uint32_t ulSeq = 0U;
+	uint32_t ulSent;
+	uint32_t ulReceived;
+	uint32_t ulOutstanding;
+	uint32_t ulDone;
+	uint32_t ulBytes;
+	uint32_t ulIsrCount;
+	uint32_t ulIsrTime;
+	uint32_t ulRxDropped;
+	uint32_t ulTxTimeouts;
+	TickType_t xRunStart;
+	XTime xStart;
+	XTime xStop;
+	uint64_t ullElapsed;
+
+	vTaskDelay(pdMS_TO_TICKS(BENCH_START_DELAY_MS));
+
+	while(1)
+	{
+
+		/* Counters at the start of the run. */
+		ulReceived = ulBenchResponses;
+		ulBytes = pxChan->ulTxByteCount;
+		ulIsrCount = pxChan->ulIsrCount;
+		ulIsrTime = pxChan->ulIsrTimeTotal;
+		ulRxDropped = pxChan->ulRxDroppedBytes + pxChan->ulRxOverrunCount +
+					  pxChan->ulRxDiscardCount + pxChan->ulRxResyncCount;
+		ulTxTimeouts = pxChan->ulTxTimeoutCount;
+		pxChan->ulIsrTimeMax = 0U;
+		(void)ulTaskNotifyTake(pdTRUE, 0U);
+
+		XTime_GetTime(&xStart);
+		xRunStart = xTaskGetTickCount();
+
+		/* Fill the pipeline, then send a new frame for each response. */
+		for (ulSent = 0U; ulSent < BENCH_FRAMES_IN_FLIGHT; ulSent++)
+		{
+			vBenchSendFrame(pxChan, ulSeq++);
+		}
+		ulOutstanding = BENCH_FRAMES_IN_FLIGHT;
+
+		while ((xTaskGetTickCount() - xRunStart) < pdMS_TO_TICKS(BENCH_RUN_MS))
+		{
+			ulDone = ulTaskNotifyTake(pdTRUE, BENCH_RESPONSE_TIMEOUT);
+			if (ulDone == 0U)
+			{
+				/* Nothing came back: the outstanding frames are lost, start again. */
+				ulDone = ulOutstanding;
+			}
+			ulOutstanding -= (ulDone < ulOutstanding) ? ulDone : ulOutstanding;
+
+			while (ulOutstanding < BENCH_FRAMES_IN_FLIGHT)
+			{
+				vBenchSendFrame(pxChan, ulSeq++);
+				ulSent++;
+				ulOutstanding++;
+			}
+		}
+
+		/* Let the outstanding frames come back. */
+		while (ulOutstanding != 0U)
+		{
+			ulDone = ulTaskNotifyTake(pdTRUE, BENCH_RESPONSE_TIMEOUT);
+			if (ulDone == 0U)
+			{
+				break;
+			}
+			ulOutstanding -= (ulDone < ulOutstanding) ? ulDone : ulOutstanding;
+		}
+
+		XTime_GetTime(&xStop);
+		ullElapsed = (uint64_t)(xStop - xStart);
+		ulReceived = ulBenchResponses - ulReceived;
+		ulIsrCount = pxChan->ulIsrCount - ulIsrCount;
+
+		xResult.ulRuns++;
+		xResult.ulRoundTripsPerSec = (uint32_t)(((uint64_t)ulReceived * COUNTS_PER_SECOND) / ullElapsed);
+		xResult.ulBytesPerSec = (uint32_t)(((uint64_t)(pxChan->ulTxByteCount - ulBytes) * COUNTS_PER_SECOND) / ullElapsed);
+		xResult.ulIsrCount = ulIsrCount;
+		xResult.ulIsrAvgNs = (ulIsrCount == 0U) ? 0U :
+				(uint32_t)(((uint64_t)(pxChan->ulIsrTimeTotal - ulIsrTime) * 1000000000ULL) / COUNTS_PER_SECOND / ulIsrCount);
+		xResult.ulIsrMaxNs = (uint32_t)(((uint64_t)pxChan->ulIsrTimeMax * 1000000000ULL) / COUNTS_PER_SECOND);
+		xResult.ulLost = (ulSent > ulReceived) ? (ulSent - ulReceived) : 0U;
+		xResult.ulRxDropped = (pxChan->ulRxDroppedBytes + pxChan->ulRxOverrunCount +
+							   pxChan->ulRxDiscardCount + pxChan->ulRxResyncCount) - ulRxDropped;
+		xResult.ulTxTimeouts = pxChan->ulTxTimeoutCount - ulTxTimeouts;
+
+		taskENTER_CRITICAL();
+		xBenchResult = xResult;
+		taskEXIT_CRITICAL();
+
+		DLOG3(eLogBenchRate, xResult.ulRuns, xResult.ulRoundTripsPerSec, xResult.ulBytesPerSec);
+		DLOG3(eLogBenchIsr, xResult.ulIsrCount, xResult.ulIsrAvgNs, xResult.ulIsrMaxNs);
+		DLOG3(eLogBenchDrops, xResult.ulLost, xResult.ulRxDropped, xResult.ulTxTimeouts);
+
+		vTaskDelay(pdMS_TO_TICKS(BENCH_PAUSE_MS));
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vBenchSendFrame()
+ *//**
+ *
+ * @brief	Builds a CMD_BENCH_ECHO frame (field1 = sequence number, then
+ * 			BENCH_PAYLOAD_WORDS data words) in a packet from the channel's
+ * 			pool and queues it on the channel's Tx task, as if it were a
+ * 			response.
+ *
+******************************************************************************/
+
+static void vBenchSendFrame( CmdChannel_s *pxChan, uint32_t ulSeq )
+{
+
+	Pkt_s *pxPkt = pxPktPoolGet(&pxChan->xTxPool, portMAX_DELAY);
+	uint8_t *pucFrame = &pxPkt->ucBuffer[PKT_HEADROOM];
+	uint32_t ulWord;
+
+	vCmdStoreBE32(&pucFrame[0], ((uint32_t)CMD_BENCH_ECHO << 16) | BENCH_PAYLOAD_WORDS);
+	vCmdStoreBE32(&pucFrame[4], ulSeq);
+	for (ulWord = 0U; ulWord < CMD_FRAME_FIELDS - 1U; ulWord++)
+	{
+		vCmdStoreBE32(&pucFrame[8U + (4U * ulWord)], (ulWord < BENCH_PAYLOAD_WORDS) ? (ulSeq * 0x01000193U) ^ ulWord : 0U);
+	}
+
+	XTime_GetTime((XTime *)&pxPkt->ullTimestamp);
+	vCmdPacketFinish(pxChan, pxPkt, CMD_FRAME_SIZE);
+
+	xQueueSend(pxChan->xTxQueue, &pxPkt, portMAX_DELAY);
+}
+#endif
+
+
+
+/*****************************************************************************
+ * Function: xUart1ChangeBaudRate( uint32_t ulBaudRate )
+ *//**
+ *
+ * @brief	Sets the UART1 baud rate. Returns XST_SUCCESS or XST_FAILURE.
+ *
+******************************************************************************/
+
+static int xUart1ChangeBaudRate( uint32_t ulBaudRate )
+{
+
+	int status;
+
+	status = xUartPs1SetBaudRate(&xUartPs1Inst, ulBaudRate);
+
+	DLOG1((status == XST_SUCCESS) ? eLogBaudRateSet : eLogBaudRateFailed, ulBaudRate);
+
+	return status;
+}
+
+
+/* --- END TASKS ---------------------------------------------------------*/
+
+
+
+
+/*============================================*/
+/* =========== APPLICATION COMMANDS ==========*/
+/*============================================*/
+
+
+/*****************************************************************************
+ * Function: cmdGetUartTransCount()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_UART_TRANS_COUNT.
+ * 			Returns the number of completed UART Rx-Tx transactions in the
+ * 			first response word.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetUartTransCount(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	setResponseBytes(tx_data, ulUartTransactionCount);
+	return 1U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdDmaCopy()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_DMA_COPY.
+ * 			field1 = destination, field2 = source, field3 = length in bytes.
+ * 			The command task blocks until the DMA is done, so the periodic
+ * 			tasks keep running during large copies.
+ *
+******************************************************************************/
+
+static uint32_t cmdDmaCopy(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	if (xDmaPsCopy(p_frame->field1, p_frame->field2, p_frame->field3) != XST_SUCCESS)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(tx_data, WRITE_OKAY);
+	return 1U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdDmaFill()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_DMA_FILL.
+ * 			field1 = destination, field2 = 32-bit pattern, field3 = length
+ * 			in bytes.
+ *
+******************************************************************************/
+
+static uint32_t cmdDmaFill(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	if (xDmaPsFill(p_frame->field1, p_frame->field2, p_frame->field3) != XST_SUCCESS)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(tx_data, WRITE_OKAY);
+	return 1U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdDmaRead()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_DMA_READ.
+ * 			field1 = source, sz = number of words. As READ_SEQUENTIAL, but
+ * 			the words are fetched by the DMA straight into the response
+ * 			(up to 16 words in a 64-byte frame, more in a long frame), then
+ * 			byte-swapped in place.
+ *
+ * @note	The DMA destination is not a whole number of cache lines: in a
+ * 			long frame tx_data is 12 bytes (the frame header) past the
+ * 			line-aligned PKT_HEADROOM, and the copy can end in the middle of
+ * 			a line. Those partial lines are shared with other bytes of the
+ * 			same packet's ucBuffer.
+ *
+******************************************************************************/
+
+static uint32_t cmdDmaRead(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t idx;
+	uint32_t word;
+
+	/* Safe without a bounce buffer only because: xDmaPsTransfer() flushes the
+	 * whole destination, partial lines included, before the transfer; and no
+	 * one writes to those partial lines until it returns. They hold the rest
+	 * of this Tx packet's buffer (frame header, rest of the response), which
+	 * only this worker uses while the command runs: the header and padding
+	 * are written by finishResponse() and vCmdPacketFinish(), after the
+	 * command returns. Any write to them while the DMA is running (e.g.
+	 * building part of the response before the copy) could be lost, or
+	 * overwrite DMA data. */
+	if (xDmaPsCopy((UINTPTR)tx_data, p_frame->field1, 4U * p_frame->sz) != XST_SUCCESS)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		memcpy(&word, &tx_data[4U * idx], sizeof(word));
+		setResponseBytes(&tx_data[4U * idx], word);
+	}
+
+	return p_frame->sz;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdGetCrcErrorCount()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_CRC_ERROR_COUNT.
+ * 			Returns the number of frames received on this channel that were
+ * 			rejected because of a bad CRC trailer in the first response word.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetCrcErrorCount(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	setResponseBytes(tx_data, ulCmdHandlerCtxCrcErrors(p_frame->p_ctx));
+	return 1U;
+}
+
+
+/*****************************************************************************
+ * Function: cmdGetRxStats()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_RX_STATS.
+ * 			Returns the receive counters of the channel the command came
+ * 			in on: word 0 = RX FIFO overruns,
+ * 			word 1 = bytes dropped because the Rx ring was full, word 2 =
+ * 			incomplete frames discarded, word 3 = most bytes held in the Rx
+ * 			ring at once, word 4 = COBS frames dropped to resynchronise.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetRxStats(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const CmdChannel_s *pxChan = pxCmdChannelFromFrame(p_frame);
+
+	if (pxChan == NULL)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(&tx_data[0], pxChan->ulRxOverrunCount);
+	setResponseBytes(&tx_data[4], pxChan->ulRxDroppedBytes);
+	setResponseBytes(&tx_data[8], pxChan->ulRxDiscardCount);
+	setResponseBytes(&tx_data[12], pxChan->xRxRing.ulHighWater);
+	setResponseBytes(&tx_data[16], pxChan->ulRxResyncCount);
+	return 5U;
+}
+
+
+/*****************************************************************************
+ * Function: cmdGetTxStats()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_TX_STATS.
+ * 			Returns the transmit counters of the channel the command came
+ * 			in on: word 0 = responses sent,
+ * 			word 1 = responses with no SENT_DATA event in time (see
+ * 			xCmdTxDoneTimeout) and aborted, word 2 = latency of the last response and
+ * 			word 3 = largest latency, in microseconds from the end of the
+ * 			request frame to the end of the response. The response to this
+ * 			command is still being built, so the figures cover the earlier
+ * 			responses only.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetTxStats(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const CmdChannel_s *pxChan = pxCmdChannelFromFrame(p_frame);
+
+	if (pxChan == NULL)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(&tx_data[0], pxChan->ulTxFrameCount);
+	setResponseBytes(&tx_data[4], pxChan->ulTxTimeoutCount);
+	setResponseBytes(&tx_data[8], pxChan->ulTxLatencyLast);
+	setResponseBytes(&tx_data[12], pxChan->ulTxLatencyMax);
+	return 4U;
+}
+
+
+/*****************************************************************************
+ * Function: cmdSetBaudRate()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_SET_BAUD_RATE.
+ * 			field1 = new baud rate (UART1_BAUD_RATE_MIN to UART1_BAUD_RATE_MAX),
+ * 			field2 = probe window in ms (0 = CMD_BAUD_PROBE_WINDOW_MS, at most
+ * 			CMD_BAUD_PROBE_MAX_WINDOW_MS). The response is sent at the current
+ * 			rate: word 0 = current rate, word 1 = new rate, word 2 = probe
+ * 			window. The rate changes once the response has been sent; the
+ * 			host should wait a few ms after it before sending the probe.
+ * 			Rejected while an earlier change is waiting to be confirmed, and
+ * 			on channels other than UART1.
+ *
+******************************************************************************/
+
+static uint32_t cmdSetBaudRate(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t ulWindow = (p_frame->field2 == 0U) ? CMD_BAUD_PROBE_WINDOW_MS : p_frame->field2;
+
+	CmdChannel_s *pxChan = pxCmdChannelFromFrame(p_frame);
+
+	if ( (pxChan == NULL) || (pxChan->eDataSource != eUART1) ||
+		 (p_frame->field1 < UART1_BAUD_RATE_MIN) || (p_frame->field1 > UART1_BAUD_RATE_MAX) ||
+		 (ulWindow > CMD_BAUD_PROBE_MAX_WINDOW_MS) || (ulUart1BaudFallback != 0U) ||
+		 (xBaudProbeTimer == NULL) )
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	xUart1BaudProbeWindow = pdMS_TO_TICKS( ulWindow );
+	ulUart1BaudFallback = xUartPs1Inst.BaudRate;
+	pxChan->ulTxBaudPending = p_frame->field1;
+
+	setResponseBytes(&tx_data[0], xUartPs1Inst.BaudRate);
+	setResponseBytes(&tx_data[4], p_frame->field1);
+	setResponseBytes(&tx_data[8], ulWindow);
+	return 3U;
+}
+
+
+/*****************************************************************************
+ * Function: cmdConfirmBaudRate()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_CONFIRM_BAUD_RATE.
+ * 			The probe: received at the new rate, it stops the probe timer so
+ * 			the new rate is kept. Also valid with no change in progress.
+ * 			UART1 only.
+ * 			Returns word 0 = rate in use, word 1 = probes that timed out.
+ *
+******************************************************************************/
+
+static uint32_t cmdConfirmBaudRate(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const CmdChannel_s *pxChan = pxCmdChannelFromFrame(p_frame);
+	uint32_t ulFallback;
+
+	if ( (pxChan == NULL) || (pxChan->eDataSource != eUART1) )
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	taskENTER_CRITICAL();
+	ulFallback = ulUart1BaudFallback;
+	ulUart1BaudFallback = 0U;
+	taskEXIT_CRITICAL();
+
+	if (ulFallback != 0U)
+	{
+		xTimerStop(xBaudProbeTimer, 0);
+	}
+
+	setResponseBytes(&tx_data[0], xUartPs1Inst.BaudRate);
+	setResponseBytes(&tx_data[4], ulUart1BaudFallbackCount);
+	return 2U;
+}
+
+
+
+#if DLOG_HOST_DECODE
+/*****************************************************************************
+ * Function: cmdReadLog()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_READ_LOG.
+ * 			Removes up to sz records (0 = as many as fit) from the deferred
+ * 			log and returns them for the host to format. Word 0 = records
+ * 			dropped because the log was full, then 7 words per record:
+ * 			message ID (LogId_t) << 16 | argument count, timestamp (global
+ * 			timer counts, upper word then lower word) and the 4 arguments.
+ * 			A 64-byte frame returns up to two records: (resp_words - 1) / 7
+ * 			is 2 with or without a CRC. A long frame returns more.
+ *
+******************************************************************************/
+
+#define CMD_READ_LOG_RECORD_WORDS	7U
+
+static uint32_t cmdReadLog(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	DlogRecord_s xRec;
+	uint32_t ulMax;
+	uint32_t ulWords = 1U;
+	uint32_t ulCount;
+
+	if (p_frame->resp_words == 0U)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	ulMax = (p_frame->resp_words - 1U) / CMD_READ_LOG_RECORD_WORDS;
+	if ((p_frame->sz != 0U) && (p_frame->sz < ulMax))
+	{
+		ulMax = p_frame->sz;
+	}
+
+	/* The log has a single reader: keep the other worker task out. */
+	vTaskSuspendAll();
+	for (ulCount = 0U; (ulCount < ulMax) && (ulDlogRead(&xRec) != 0U); ulCount++)
+	{
+		setResponseBytes(&tx_data[ulWords * 4U], ((uint32_t)xRec.usId << 16) | xRec.usArgCount);
+		setResponseBytes(&tx_data[(ulWords + 1U) * 4U], (uint32_t)(xRec.xTime >> 32));
+		setResponseBytes(&tx_data[(ulWords + 2U) * 4U], (uint32_t)xRec.xTime);
+		setResponseBytes(&tx_data[(ulWords + 3U) * 4U], xRec.ulArg[0]);
+		setResponseBytes(&tx_data[(ulWords + 4U) * 4U], xRec.ulArg[1]);
+		setResponseBytes(&tx_data[(ulWords + 5U) * 4U], xRec.ulArg[2]);
+		setResponseBytes(&tx_data[(ulWords + 6U) * 4U], xRec.ulArg[3]);
+		ulWords += CMD_READ_LOG_RECORD_WORDS;
+	}
+	xTaskResumeAll();
+
+	setResponseBytes(&tx_data[0], ulDlogDroppedCount());
+	return ulWords;
+}
+#endif
+
+
+
+/*****************************************************************************
+ * Function: cmdGetIsrStats()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_ISR_STATS.
+ * 			Returns the UART interrupt handler figures of the channel the
+ * 			command came in on: word 0 = interrupts handled, word 1 = time
+ * 			of the last one and word 2 = longest time, in nanoseconds
+ * 			(see vUartCmdIntrHandler), word 3 = UART_CMD_FAST_ISR.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetIsrStats(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const CmdChannel_s *pxChan = pxCmdChannelFromFrame(p_frame);
+
+	if (pxChan == NULL)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(&tx_data[0], pxChan->ulIsrCount);
+	setResponseBytes(&tx_data[4], (uint32_t)(((uint64_t)pxChan->ulIsrTimeLast * 1000000000ULL) / COUNTS_PER_SECOND));
+	setResponseBytes(&tx_data[8], (uint32_t)(((uint64_t)pxChan->ulIsrTimeMax * 1000000000ULL) / COUNTS_PER_SECOND));
+	setResponseBytes(&tx_data[12], UART_CMD_FAST_ISR);
+	return 4U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdBenchEcho()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_BENCH_ECHO, the
+ * 			benchmark traffic (see vLoopbackBenchTask; a host can send it
+ * 			too). Field 1 = sequence number, followed by sz data words.
+ * 			Response: word 0 = BENCH_RESP_MARK, word 1 = sequence number,
+ * 			then the sz data words.
+ *
+******************************************************************************/
+
+static uint32_t cmdBenchEcho(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t ulWord;
+
+	if (((uint32_t)p_frame->sz + 2U) > p_frame->resp_words)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	setResponseBytes(&tx_data[0], BENCH_RESP_MARK);
+	setResponseBytes(&tx_data[4], p_frame->field1);
+	for (ulWord = 0U; ulWord < p_frame->sz; ulWord++)
+	{
+		setResponseBytes(&tx_data[8U + (4U * ulWord)], ulCmdLoadBE32(&p_frame->p_data[4U * ulWord]));
+	}
+
+	return (uint32_t)p_frame->sz + 2U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdGetBenchResult()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_BENCH_RESULT.
+ * 			Returns the last loopback benchmark run (all zero unless built
+ * 			with UART1_LOOPBACK_BENCH): word 0 = runs, word 1 = round trips
+ * 			per second, word 2 = bytes per second, word 3 = UART interrupts,
+ * 			word 4 = average and word 5 = longest interrupt handler time in
+ * 			ns, word 6 = frames lost, word 7 = Rx bytes and frames dropped,
+ * 			word 8 = Tx timeouts.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetBenchResult(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	BenchResult_s xResult;
+
+	taskENTER_CRITICAL();
+	xResult = xBenchResult;
+	taskEXIT_CRITICAL();
+
+	setResponseBytes(&tx_data[0], xResult.ulRuns);
+	setResponseBytes(&tx_data[4], xResult.ulRoundTripsPerSec);
+	setResponseBytes(&tx_data[8], xResult.ulBytesPerSec);
+	setResponseBytes(&tx_data[12], xResult.ulIsrCount);
+	setResponseBytes(&tx_data[16], xResult.ulIsrAvgNs);
+	setResponseBytes(&tx_data[20], xResult.ulIsrMaxNs);
+	setResponseBytes(&tx_data[24], xResult.ulLost);
+	setResponseBytes(&tx_data[28], xResult.ulRxDropped);
+	setResponseBytes(&tx_data[32], xResult.ulTxTimeouts);
+	return 9U;
+}
+
+
+
+#if TIMER_TASK_TIMING
+/*****************************************************************************
+ * Function: cmdGetTimingStats()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_TIMING_STATS.
+ * 			sz = timer task (TIMING_TASK1/2), field 1 = metric
+ * 			(TimingMetric_t), field 2 = 1 to clear that histogram after
+ * 			reading it. Response, times in ns: word 0 = samples, word 1 =
+ * 			min, word 2 = mean, word 3 = max, words 4 - 7 = 50th, 90th, 99th
+ * 			and 99.9th percentiles (bucket resolution), word 8 = samples
+ * 			beyond the histogram range.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetTimingStats(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	TimingHist_s *pxHist;
+
+	if (p_frame->field1 >= (uint32_t)eTimingMetricCount)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	pxHist = &xTaskTiming[p_frame->sz].xHist[p_frame->field1];
+
+	/* The timer task adds samples in task context: keep it out while the
+	 * histogram is read (and cleared). */
+	vTaskSuspendAll();
+	setResponseBytes(&tx_data[0], pxHist->ulCount);
+	setResponseBytes(&tx_data[4], (pxHist->ulCount != 0U) ? pxHist->ulMinNs : 0U);
+	setResponseBytes(&tx_data[8], ulTimingHistMean(pxHist));
+	setResponseBytes(&tx_data[12], pxHist->ulMaxNs);
+	setResponseBytes(&tx_data[16], ulTimingHistPercentile(pxHist, 500U));
+	setResponseBytes(&tx_data[20], ulTimingHistPercentile(pxHist, 900U));
+	setResponseBytes(&tx_data[24], ulTimingHistPercentile(pxHist, 990U));
+	setResponseBytes(&tx_data[28], ulTimingHistPercentile(pxHist, 999U));
+	setResponseBytes(&tx_data[32], pxHist->ulOverflow);
+	if ((p_frame->field2 & 1U) != 0U)
+	{
+		vTimingHistClear(pxHist);
+	}
+	xTaskResumeAll();
+
+	return 9U;
+}
+
+
+
+/*****************************************************************************
+ * Function: cmdGetTimingHist()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_TIMING_HIST.
+ * 			sz = timer task, field 1 = metric, field 2 = first bucket.
+ * 			Response: word 0 = bucket width in ns, word 1 = samples beyond
+ * 			the histogram range, then the counts of the buckets from field 2,
+ * 			as many as fit in the response (up to TIMING_HIST_BUCKETS).
+ *
+******************************************************************************/
+
+static uint32_t cmdGetTimingHist(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const TimingHist_s *pxHist;
+	uint32_t ulBucket;
+	uint32_t ulWords = 2U;
+
+	if ( (p_frame->field1 >= (uint32_t)eTimingMetricCount) ||
+		 (p_frame->field2 >= TIMING_HIST_BUCKETS) ||
+		 (p_frame->resp_words < 3U) )
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	pxHist = &xTaskTiming[p_frame->sz].xHist[p_frame->field1];
+
+	vTaskSuspendAll();
+	setResponseBytes(&tx_data[0], pxHist->ulBucketNs);
+	setResponseBytes(&tx_data[4], pxHist->ulOverflow);
+	for (ulBucket = p_frame->field2;
+		 (ulBucket < TIMING_HIST_BUCKETS) && (ulWords < p_frame->resp_words);
+		 ulBucket++)
+	{
+		setResponseBytes(&tx_data[ulWords * 4U], pxHist->ulBuckets[ulBucket]);
+		ulWords++;
+	}
+	xTaskResumeAll();
+
+	return ulWords;
+}
+#endif /* TIMER_TASK_TIMING */
+
+
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+/*****************************************************************************
+ * Function: cmdGetTaskRunTime()
+ *//**
+ *
+ * @brief	Command handler execution function for CMD_GET_TASK_RUN_TIME.
+ * 			Run times are in global timer counts (COUNTS_PER_SECOND, 3 ns)
+ * 			since the scheduler started. sz = first task to report, in
+ * 			order of task number. Response: word 0 = number of tasks,
+ * 			words 1 - 2 = total run time (high, low), word 3 =
+ * 			COUNTS_PER_SECOND, then CMD_RUN_TIME_TASK_WORDS words per task:
+ * 			task number, run time (high, low), first 16 characters of the
+ * 			name. As many tasks as fit in the response.
+ *
+ * @note	Two workers can run this at the same time (one per channel):
+ * 			the shared snapshot is held under xRunTimeStatusMutex. The
+ * 			scheduler is only suspended for the snapshot itself, so the
+ * 			sort and copy-out do not hold back the timer tasks.
+ *
+******************************************************************************/
+
+static uint32_t cmdGetTaskRunTime(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	TaskStatus_t xTmp;
+	configRUN_TIME_COUNTER_TYPE ullTotal;
+	UBaseType_t uxTasks;
+	UBaseType_t uxTask;
+	UBaseType_t uxPos;
+	uint32_t ulWords = CMD_RUN_TIME_HDR_WORDS;
+	uint32_t ulName[4];
+	uint32_t ulChar;
+	uint32_t i;
+
+	if (p_frame->resp_words < CMD_RUN_TIME_HDR_WORDS)
+	{
+		return CMD_HANDLER_ERROR;
+	}
+
+	xSemaphoreTake(xRunTimeStatusMutex, portMAX_DELAY);
+
+	/* Counters and task list read in one go, so the per-task times add up to
+	 * (about) the total. */
+	vTaskSuspendAll();
+	uxTasks = uxTaskGetSystemState(xRunTimeStatus, CMD_RUN_TIME_MAX_TASKS, &ullTotal);
+	xTaskResumeAll();
+
+	if (uxTasks == 0U)
+	{
+		xSemaphoreGive(xRunTimeStatusMutex);
+		return CMD_HANDLER_ERROR;		// More tasks than CMD_RUN_TIME_MAX_TASKS
+	}
+
+	/* Task list order depends on task states; sort by task number so that sz
+	 * pages through the same order on each request. */
+	for (uxTask = 1U; uxTask < uxTasks; uxTask++)
+	{
+		xTmp = xRunTimeStatus[uxTask];
+		for (uxPos = uxTask; (uxPos > 0U) && (xRunTimeStatus[uxPos - 1U].xTaskNumber > xTmp.xTaskNumber); uxPos--)
+		{
+			xRunTimeStatus[uxPos] = xRunTimeStatus[uxPos - 1U];
+		}
+		xRunTimeStatus[uxPos] = xTmp;
+	}
+
+	setResponseBytes(&tx_data[0], (uint32_t)uxTasks);
+	setResponseBytes(&tx_data[4], (uint32_t)((uint64_t)ullTotal >> 32));
+	setResponseBytes(&tx_data[8], (uint32_t)ullTotal);
+	setResponseBytes(&tx_data[12], (uint32_t)COUNTS_PER_SECOND);
+
+	for (uxTask = p_frame->sz;
+		 (uxTask < uxTasks) && (ulWords + CMD_RUN_TIME_TASK_WORDS <= p_frame->resp_words);
+		 uxTask++)
+	{
+		setResponseBytes(&tx_data[ulWords * 4U], (uint32_t)xRunTimeStatus[uxTask].xTaskNumber);
+		setResponseBytes(&tx_data[(ulWords + 1U) * 4U], (uint32_t)((uint64_t)xRunTimeStatus[uxTask].ulRunTimeCounter >> 32));
+		setResponseBytes(&tx_data[(ulWords + 2U) * 4U], (uint32_t)xRunTimeStatus[uxTask].ulRunTimeCounter);
+
+		/* Name packed 4 characters per word, first character in the MSB,
+		 * zero padded. */
+		memset(ulName, 0, sizeof(ulName));
+		for (ulChar = 0U;
+			 (ulChar < 16U) && (ulChar < configMAX_TASK_NAME_LEN) &&
+			 (xRunTimeStatus[uxTask].pcTaskName[ulChar] != '\0');
+			 ulChar++)
+		{
+			ulName[ulChar / 4U] |= (uint32_t)(uint8_t)xRunTimeStatus[uxTask].pcTaskName[ulChar] << (24U - ((ulChar % 4U) * 8U));
+		}
+		for (i = 0U; i < 4U; i++)
+		{
+			setResponseBytes(&tx_data[(ulWords + 3U + i) * 4U], ulName[i]);
+		}
+
+		ulWords += CMD_RUN_TIME_TASK_WORDS;
+	}
+
+	xSemaphoreGive(xRunTimeStatusMutex);
+
+	return ulWords;
+}
+#endif /* configGENERATE_RUN_TIME_STATS */
+
+
+
+/* --- END APPLICATION COMMANDS ------------------------------------------*/
 
 
 
 
 /*============================================*/
-/* =========== INTERRUPT HANDLERS ============*/
-/*============================================*/
+/* =========== INTERRUPT HANDLERS ============*/
+/*============================================*/
 
 
 /*****************************************************************************
@@ -594,8 +2406,10 @@ static void vUartCommsDoneNotifiedTask( void *pvParameters )
  *//**
  *
  * @brief	UART interrupt handler, used in conjunction with the Command Handler
- * 			tasks. When a (HW) UART interrupt is detected, this ISR is called. It
- * 			extracts the data from the UART buffer and sends it to vCommandHandlerRxTask.
+ * 			tasks, for both UARTs (CallBackRef is the driver instance, which
+ * 			gives the channel). When a (HW) UART interrupt is detected, this ISR
+ * 			is called. It extracts the data from the UART buffer and sends it to
+ * 			the channel's vCommandHandlerRxTask.
  *
 ******************************************************************************/
 
@@ -606,23 +2420,78 @@ void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_
 	BaseType_t xHigherPriorityTaskWoken;
 	xHigherPriorityTaskWoken = pdFALSE;
 
+	CmdChannel_s *pxChan = pxCmdChannelFromUart((XUartPs *)CallBackRef);
+	uint8_t *pucRxDst;
+	uint32_t ulSpace;
+	uint32_t ulCount;
+	uint32_t ulReceived = 0U;
+
+	if (pxChan == NULL)
+	{
+		return;
+	}
+
 
 	// --------------------------------------------------------------------------------- //
-	// event == XUARTPS_EVENT_RECV_DATA
-	// 64 bytes should now have been received from the host.
+	// event == XUARTPS_EVENT_RECV_DATA / XUARTPS_EVENT_RECV_TOUT
+	// Streaming mode: the RX FIFO has reached its trigger level, or the line
+	// has gone idle with bytes still in the FIFO (the driver reports the timeout
+	// as RECV_DATA, as no XUartPs_Recv() buffer is pending). Drain the FIFO; the
+	// bytes are framed by the Rx task.
+	// Block mode: 64 bytes (one frame, or one block of a long frame) should now
+	// have been received from the host.
 	// --------------------------------------------------------------------------------- //
-	if (event == XUARTPS_EVENT_RECV_DATA)
+	if ( (event == XUARTPS_EVENT_RECV_DATA) || (event == XUARTPS_EVENT_RECV_TOUT) )
 	{
 
 		psGpOutSet(PS_GP_OUT4);	/// TEST SIGNAL: SET UART RX INTR
 
 
 		/* === RX FROM HOST === */
-		/* Get the data received from the host */
-		XUartPs_Recv(&xUartPs1Inst, CmdHandlerUart1RxPkt.RxBuffer, UART_RX_BUFFER_SIZE);
+		if (pxChan->ucRxStreaming)
+		{
+			/* Read the FIFO straight into the ring: at most two passes, as the
+			 * free region may wrap. If the ring is full the FIFO is still
+			 * drained (into the scratch buffer), otherwise the interrupt would
+			 * keep firing; those bytes are counted as dropped. */
+			do
+			{
+				pucRxDst = pucByteRingWriteRegion(&pxChan->xRxRing, &ulSpace);
+				if (ulSpace == 0U)
+				{
+					pucRxDst = pxChan->ucRxScratch;
+					ulSpace = sizeof(pxChan->ucRxScratch);
+				}
+
+				ulCount = ulUartPs1ReadFifo(pxChan->pxUart, pucRxDst, ulSpace);
+
+				if (pucRxDst == pxChan->ucRxScratch)
+				{
+					pxChan->ulRxDroppedBytes += ulCount;
+				}
+				else
+				{
+					vByteRingProduce(&pxChan->xRxRing, ulCount);
+					ulReceived += ulCount;
+				}
+
+			} while (ulCount == ulSpace);
+
+			vUartPs1RestartRxTimeout(pxChan->pxUart);
+		}
+		else
+		{
+			/* Get the block received from the host, and pass it to the Rx task */
+			XUartPs_Recv(pxChan->pxUart, pxChan->ucRxScratch, UART_RX_BUFFER_SIZE);
+			ulReceived = ulByteRingWrite(&pxChan->xRxRing, pxChan->ucRxScratch, UART_RX_BUFFER_SIZE);
+			pxChan->ulRxDroppedBytes += UART_RX_BUFFER_SIZE - ulReceived;
+		}
 
-		/* Send the packet to the Command Handler Rx Task. */
-		xQueueSendToFrontFromISR(xCmdHandlerRxQueue, &CmdHandlerUart1RxPkt, &xHigherPriorityTaskWoken);
+		/* Wake the Rx task. */
+		if (ulReceived != 0U)
+		{
+			vTaskNotifyGiveFromISR(pxChan->xRxTask_h, &xHigherPriorityTaskWoken);
+		}
 		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
 		psGpOutClear(PS_GP_OUT4); /// TEST SIGNAL: CLEAR UART RX INTR
@@ -630,21 +2499,30 @@ void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_
 	}
 
 
+	// --------------------------------------------------------------------------------- //
+	// event == XUARTPS_EVENT_RECV_ERROR
+	// RX FIFO overrun (streaming mode): bytes were lost, the Rx task
+	// resynchronises on its timeout.
+	// --------------------------------------------------------------------------------- //
+	else if (event == XUARTPS_EVENT_RECV_ERROR)
+	{
+		pxChan->ulRxOverrunCount++;
+		DLOG1(eLogRxOverrun, pxChan->eDataSource);
+	}
+
+
 	// --------------------------------------------------------------------------------- //
 	// event == XUARTPS_EVENT_SENT_DATA
-	// This event should occur when data is sent back to the host.
-	// We don't really need to do anything with this event, but we could
-	// use it in the future to trigger another task (for example).
+	// This event occurs when the last byte of the response has left the
+	// TX FIFO. Timestamp it, release the Tx task (and so its packet) and
+	// tell the notified task that the transaction is complete.
 	// --------------------------------------------------------------------------------- //
 	else if (event == XUARTPS_EVENT_SENT_DATA)
 	{
 
-		psGpOutSet(PS_GP_OUT5);		/// TEST SIGNAL: SET UART TX INTR
+		vCmdChannelTxDoneFromISR(pxChan, &xHigherPriorityTaskWoken);
 
-		// Dummy delay so that GPIO signal can be clearly seen on scope.
-		for (int i = 100; i >=0; i--) {}
-
-		psGpOutClear(PS_GP_OUT5);	/// TEST SIGNAL: CLEAR UART TX INTR
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
 	}
  }
@@ -657,86 +2535,477 @@ void vUartIntrHandlerForQueue(void *CallBackRef, uint32_t event, uint32_t event_
 
 
 /*****************************************************************************
- * Function: vTtc0_0_IntrHandler(void* CallBackRef)
+ * Function: vUartCmdIntrHandler()
  *//**
  *
- * @brief	TTC0-0 interrupt handler. Called when an interval interrupt occurs
- * 			in TTC0-0. It sends a semaphore to vPeriodicTimerTask1, unblocking
- * 			that task.
+ * @brief	UART interrupt handler of both command channels, connected to the
+ * 			interrupt controller (CallBackRef is the driver instance). Runs
+ * 			vUartFastIntrHandler() or the driver's XUartPs_InterruptHandler()
+ * 			(see UART_CMD_FAST_ISR), and records how long it took. The time
+ * 			does not include the FreeRTOS IRQ entry and exit.
  *
 ******************************************************************************/
 
+void vUartCmdIntrHandler(void *CallBackRef)
+{
 
-void vTtc0_0_IntrHandler(void* CallBackRef) {
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	CmdChannel_s *pxChan = pxCmdChannelFromUart((XUartPs *)CallBackRef);
+	XTime xStart;
+	XTime xEnd;
+	uint32_t ulTime;
 
-	axiGp0_OutSet(PMOD_JE_3); // TEST SIGNAL: Start of ISR
+	XTime_GetTime(&xStart);
+
+#if UART_CMD_FAST_ISR
+	if ( (pxChan != NULL) && pxChan->ucRxStreaming )
+	{
+		vUartFastIntrHandler(pxChan, &xHigherPriorityTaskWoken);
+	}
+	else
+#endif
+	{
+		XUartPs_InterruptHandler((XUartPs *)CallBackRef);
+	}
 
+	if (pxChan != NULL)
+	{
+		XTime_GetTime(&xEnd);
+		ulTime = (uint32_t)(xEnd - xStart);
+		pxChan->ulIsrTimeLast = ulTime;
+		if (ulTime > pxChan->ulIsrTimeMax)
+		{
+			pxChan->ulIsrTimeMax = ulTime;
+		}
+		pxChan->ulIsrTimeTotal += ulTime;
+		pxChan->ulIsrCount++;
+	}
 
-	/* Used for context switching. */
-	BaseType_t xHigherPriorityTaskWoken;
-	xHigherPriorityTaskWoken = pdFALSE;
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
 
-	/* Get the TTC interrupt status. */
-	uint32_t status_event = 0U;
-	status_event = XTtcPs_GetInterruptStatus((XTtcPs *)CallBackRef);
 
-	/* Clear the interrupt, and reset the timer. */
-	XTtcPs_ClearInterruptStatus((XTtcPs *)CallBackRef, status_event);
-	resetTtc(CallBackRef);
 
-	/* Give the semaphore to the blocked task. */
-	xSemaphoreGiveFromISR(xPeriodTimerTask1Semaphore, &xHigherPriorityTaskWoken);
-	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+#if UART_CMD_FAST_ISR
+/*****************************************************************************
+ * Function: vUartFastIntrHandler()
+ *//**
+ *
+ * @brief	Register-level UART interrupt handler for a streaming mode
+ * 			channel. Does the work of vUartIntrHandlerForQueue without the
+ * 			driver's per-byte status register reads:
+ * 			- RX: on RXOVR, confirmed by the status register, at least
+ * 			  ulRxTriggerLevel bytes are in the FIFO, so they are read
+ * 			  straight into the Rx ring without further status reads; only
+ * 			  the bytes that arrived after the trigger (and those left on a
+ * 			  timeout) are read one by one.
+ * 			- TX: on TXEMPTY the FIFO is empty, so up to UART_FIFO_DEPTH
+ * 			  bytes of the response are written after one status register
+ * 			  read. The response was started by XUartPs_Send(),
+ * 			  and its progress is kept in the driver's SendBuffer.
+ *
+******************************************************************************/
+
+static void vUartFastIntrHandler(CmdChannel_s *pxChan, BaseType_t *pxHigherPriorityTaskWoken)
+{
 
+	XUartPs *pxUart = pxChan->pxUart;
+	UINTPTR base = pxUart->Config.BaseAddress;
+	uint32_t ulIsrStatus;
+	uint8_t *pucRxDst;
+	uint32_t ulSpace;
+	uint32_t ulCount;
+	uint32_t ulKnown;
+	uint32_t ulReceived = 0U;
 
-	axiGp0_OutClear(PMOD_JE_3); // TEST SIGNAL: End of ISR
+	/* Clear first: an event after this point interrupts again. */
+	ulIsrStatus = XUartPs_ReadReg(base, XUARTPS_IMR_OFFSET) & XUartPs_ReadReg(base, XUARTPS_ISR_OFFSET);
+	XUartPs_WriteReg(base, XUARTPS_ISR_OFFSET, ulIsrStatus);
+
+
+	// --------------------------------------------------------------------------------- //
+	// RXOVR / TOUT: drain the RX FIFO into the ring (or the scratch buffer, counted
+	// as dropped, if the ring is full). At most two passes, as the free region may wrap.
+	// --------------------------------------------------------------------------------- //
+	if ( (ulIsrStatus & (XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT)) != 0U )
+	{
+
+		psGpOutSet(PS_GP_OUT4);	/// TEST SIGNAL: SET UART RX INTR
+
+		/* The RXOVR bit is latched: it can be left over from a FIFO already
+		 * drained by this handler after a higher priority interrupt (TTC)
+		 * preempted it and the FIFO refilled past the trigger level. The
+		 * blind reads are only done if the status register says the FIFO is
+		 * still over the trigger level now; otherwise the polled reads. */
+		ulKnown = 0U;
+		if ( ((ulIsrStatus & XUARTPS_IXR_RXOVR) != 0U) &&
+			 ((XUartPs_ReadReg(base, XUARTPS_SR_OFFSET) & XUARTPS_SR_RXOVR) != 0U) )
+		{
+			ulKnown = pxChan->ulRxTriggerLevel;
+		}
+
+		do
+		{
+			pucRxDst = pucByteRingWriteRegion(&pxChan->xRxRing, &ulSpace);
+			if (ulSpace == 0U)
+			{
+				pucRxDst = pxChan->ucRxScratch;
+				ulSpace = sizeof(pxChan->ucRxScratch);
+			}
+
+			for (ulCount = 0U; (ulCount < ulSpace) && (ulKnown != 0U); ulCount++, ulKnown--)
+			{
+				pucRxDst[ulCount] = (uint8_t)XUartPs_ReadReg(base, XUARTPS_FIFO_OFFSET);
+			}
+			ulCount += ulUartPs1ReadFifo(pxUart, &pucRxDst[ulCount], ulSpace - ulCount);
+
+			if (pucRxDst == pxChan->ucRxScratch)
+			{
+				pxChan->ulRxDroppedBytes += ulCount;
+			}
+			else
+			{
+				vByteRingProduce(&pxChan->xRxRing, ulCount);
+				ulReceived += ulCount;
+			}
+
+		} while (ulCount == ulSpace);
+
+		vUartPs1RestartRxTimeout(pxUart);
+
+		if (ulReceived != 0U)
+		{
+			vTaskNotifyGiveFromISR(pxChan->xRxTask_h, pxHigherPriorityTaskWoken);
+		}
+
+		psGpOutClear(PS_GP_OUT4); /// TEST SIGNAL: CLEAR UART RX INTR
+	}
+
+
+	// --------------------------------------------------------------------------------- //
+	// OVER: RX FIFO overrun, bytes were lost.
+	// --------------------------------------------------------------------------------- //
+	if ( (ulIsrStatus & XUARTPS_IXR_OVER) != 0U )
+	{
+		pxChan->ulRxOverrunCount++;
+		DLOG1(eLogRxOverrun, pxChan->eDataSource);
+	}
+
+
+	// --------------------------------------------------------------------------------- //
+	// TXEMPTY: refill the TX FIFO, or, once the whole response has gone into
+	// it, stop the TX interrupt and report the response as sent. The status bit
+	// is latched, and can be left over from before XUartPs_Send() enabled the
+	// interrupt: the FIFO is only refilled if the status register confirms that
+	// it is empty, otherwise the next TXEMPTY event does it.
+	// --------------------------------------------------------------------------------- //
+	if ( (ulIsrStatus & XUARTPS_IXR_TXEMPTY) != 0U )
+	{
+		ulCount = pxUart->SendBuffer.RemainingBytes;
 
+		if (ulCount == 0U)
+		{
+			XUartPs_WriteReg(base, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY | XUARTPS_IXR_TXFULL);
+			vCmdChannelTxDoneFromISR(pxChan, pxHigherPriorityTaskWoken);
+		}
+		else if ( (XUartPs_ReadReg(base, XUARTPS_SR_OFFSET) & XUARTPS_SR_TXEMPTY) != 0U )
+		{
+			if (ulCount > UART_FIFO_DEPTH)
+			{
+				ulCount = UART_FIFO_DEPTH;
+			}
+
+			for (ulSpace = 0U; ulSpace < ulCount; ulSpace++)
+			{
+				XUartPs_WriteReg(base, XUARTPS_FIFO_OFFSET, pxUart->SendBuffer.NextBytePtr[ulSpace]);
+			}
+			pxUart->SendBuffer.NextBytePtr += ulCount;
+			pxUart->SendBuffer.RemainingBytes -= ulCount;
+		}
+	}
 }
+#endif
 
 
 
 /*****************************************************************************
- * Function: vTtc0_1_IntrHandler(void* CallBackRef)
+ * Function: vCmdChannelTxDoneFromISR()
  *//**
  *
- * @brief	TTC0-1 interrupt handler. Called when an interval interrupt occurs
- * 			in TTC0-1. It sends a semaphore to vPeriodicTimerTask2, unblocking
- * 			that task.
+ * @brief	Called from the UART interrupt handler when the last byte of a
+ * 			response has left the TX FIFO. Timestamps it, releases the
+ * 			channel's Tx task (and so its packet) and tells the notified task
+ * 			that the transaction is complete.
  *
 ******************************************************************************/
 
-void vTtc0_1_IntrHandler(void* CallBackRef) {
+static void vCmdChannelTxDoneFromISR(CmdChannel_s *pxChan, BaseType_t *pxHigherPriorityTaskWoken)
+{
 
+	psGpOutSet(PS_GP_OUT5);		/// TEST SIGNAL: SET UART TX INTR
 
-	axiGp0_OutSet(PMOD_JE_4); // TEST SIGNAL: Start of ISR
+	XTime_GetTime((XTime *)&pxChan->xTxDoneTime);
 
+	vTaskNotifyGiveFromISR(pxChan->xTxTask_h, pxHigherPriorityTaskWoken);
 
-	/* Used for context switching. */
-	BaseType_t xHigherPriorityTaskWoken;
-	xHigherPriorityTaskWoken = pdFALSE;
+	/* The notifier is set to increment. */
+	xTaskNotifyFromISR(xUartCommsDoneTask_h, 0x0, eIncrement, pxHigherPriorityTaskWoken);
 
-	/* Get the TTC interrupt status. */
-	uint32_t status_event = 0U;
-	status_event = XTtcPs_GetInterruptStatus((XTtcPs *)CallBackRef);
+	psGpOutClear(PS_GP_OUT5);	/// TEST SIGNAL: CLEAR UART TX INTR
+}
 
-	/* Clear the interrupt, and reset the timer. */
-	XTtcPs_ClearInterruptStatus((XTtcPs *)CallBackRef, status_event);
-	resetTtc(CallBackRef);
 
-	/* Give the semaphore to the blocked task. */
-	xSemaphoreGiveFromISR(xPeriodTimerTask2Semaphore, &xHigherPriorityTaskWoken);
+
+/*-----------------------------------------------------------*/
+
+
+
+#if TTC_MATCH_SERVICE
+
+/*****************************************************************************
+ * Function: vPeriodicTimerTask1Release(void *pvArg)
+ *//**
+ *
+ * @brief	Match event callback (TTC0-0 interrupt, every TTC0_0_PERIOD_NS).
+ * 			It notifies vPeriodicTimerTask1's handler task, unblocking it.
+ *
+******************************************************************************/
+
+static void vPeriodicTimerTask1Release(void *pvArg)
+{
+	(void) pvArg;
+
+	axiGp0_OutSet(PMOD_JE_3); // TEST SIGNAL: Start of release
+	TIMING_ISR_ENTRY(TIMING_TASK1, ulTtcMatchLatencyNs(&xTtcMatchService));
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	vDeferredIrqNotifyFromISR(&xPeriodTimerTask1Irq, 0U, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+	TIMING_ISR_EXIT(TIMING_TASK1);
+	axiGp0_OutClear(PMOD_JE_3); // TEST SIGNAL: End of release
+}
+
+
+
+/*****************************************************************************
+ * Function: vPeriodicTimerTask2Release(void *pvArg)
+ *//**
+ *
+ * @brief	Match event callback (TTC0-0 interrupt, every TTC0_1_PERIOD_NS).
+ * 			It notifies vPeriodicTimerTask2's handler task, unblocking it.
+ *
+******************************************************************************/
+
+static void vPeriodicTimerTask2Release(void *pvArg)
+{
+	(void) pvArg;
+
+	axiGp0_OutSet(PMOD_JE_4); // TEST SIGNAL: Start of release
+	TIMING_ISR_ENTRY(TIMING_TASK2, ulTtcMatchLatencyNs(&xTtcMatchService));
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	vDeferredIrqNotifyFromISR(&xPeriodTimerTask2Irq, 0U, &xHigherPriorityTaskWoken);
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
+	TIMING_ISR_EXIT(TIMING_TASK2);
+	axiGp0_OutClear(PMOD_JE_4); // TEST SIGNAL: End of release
+}
+
+#else
+
+/*****************************************************************************
+ * Function: ulTtc0_0_IntrAck(void *pvDevice)
+ *//**
+ *
+ * @brief	TTC0-0 interrupt acknowledge (deferred_irq). Called when an
+ * 			interval interrupt occurs in TTC0-0: clears the interrupt and
+ * 			resets the timer. The interrupt then notifies
+ * 			vPeriodicTimerTask1's handler task, so the ISR-exit time here
+ * 			does not include the notification.
+ *
+******************************************************************************/
+
+static uint32_t ulTtc0_0_IntrAck(void *pvDevice)
+{
+	XTtcPs *pxTtc = (XTtcPs *)pvDevice;
+	uint32_t status_event;
+
+	axiGp0_OutSet(PMOD_JE_3); // TEST SIGNAL: Start of ISR
+	TIMING_ISR_ENTRY(TIMING_TASK1, ulTtcElapsedNs(pxTtc));
+
+	/* Clear the interrupt, and reset the timer. */
+	status_event = XTtcPs_GetInterruptStatus(pxTtc);
+	XTtcPs_ClearInterruptStatus(pxTtc, status_event);
+	resetTtc(pxTtc);
+
+	TIMING_ISR_EXIT(TIMING_TASK1);
+	axiGp0_OutClear(PMOD_JE_3); // TEST SIGNAL: End of ISR
+
+	return 0U;
+}
+
+
+
+/*****************************************************************************
+ * Function: ulTtc0_1_IntrAck(void *pvDevice)
+ *//**
+ *
+ * @brief	TTC0-1 interrupt acknowledge (deferred_irq), as ulTtc0_0_IntrAck
+ * 			for vPeriodicTimerTask2.
+ *
+******************************************************************************/
+
+static uint32_t ulTtc0_1_IntrAck(void *pvDevice)
+{
+	XTtcPs *pxTtc = (XTtcPs *)pvDevice;
+	uint32_t status_event;
+
+	axiGp0_OutSet(PMOD_JE_4); // TEST SIGNAL: Start of ISR
+	TIMING_ISR_ENTRY(TIMING_TASK2, ulTtcElapsedNs(pxTtc));
+
+	/* Clear the interrupt, and reset the timer. */
+	status_event = XTtcPs_GetInterruptStatus(pxTtc);
+	XTtcPs_ClearInterruptStatus(pxTtc, status_event);
+	resetTtc(pxTtc);
 
+	TIMING_ISR_EXIT(TIMING_TASK2);
 	axiGp0_OutClear(PMOD_JE_4); // TEST SIGNAL: End of ISR
 
+	return 0U;
 }
 
+#endif /* TTC_MATCH_SERVICE */
+
 
 /* --- END INTERRUPT HANDLERS ----------------------------------------------------*/
 
 
 
+#if TIMER_TASK_TIMING
+/*============================================*/
+/* ========== TIMER TASK TIMING ==============*/
+/*============================================*/
+
+
+/*****************************************************************************
+ * Function: vTimingInit()
+ *//**
+ *
+ * @brief	Empties the timer task timing histograms. Interrupt-side times
+ * 			are in ns of bucket width TIMING_ISR_BUCKET_NS, task-side times
+ * 			TIMING_TASK_BUCKET_NS.
+ *
+******************************************************************************/
+
+static void vTimingInit(void)
+{
+	uint32_t ulTask;
+
+	memset(xTaskTiming, 0, sizeof(xTaskTiming));
+
+	for (ulTask = 0U; ulTask < TIMING_TASK_COUNT; ulTask++)
+	{
+		vTimingHistInit(&xTaskTiming[ulTask].xHist[eTimingIrqLatency], TIMING_ISR_BUCKET_NS);
+		vTimingHistInit(&xTaskTiming[ulTask].xHist[eTimingIsrExit], TIMING_ISR_BUCKET_NS);
+		vTimingHistInit(&xTaskTiming[ulTask].xHist[eTimingRelease], TIMING_TASK_BUCKET_NS);
+		vTimingHistInit(&xTaskTiming[ulTask].xHist[eTimingResponse], TIMING_TASK_BUCKET_NS);
+	}
+}
+
+
+
+/*****************************************************************************
+ * Function: vTimingIsrEntry()
+ *//**
+ *
+ * @brief	Called at the start of a timer task release (interrupt context).
+ * 			ulLatencyNs = time since the TTC event, from the TTC counter.
+ *
+******************************************************************************/
+
+static void vTimingIsrEntry(TaskTiming_s *pxTiming, uint32_t ulLatencyNs)
+{
+	XTime xNow;
+
+	XTime_GetTime(&xNow);
+	pxTiming->xIsrEntry = xNow;
+	pxTiming->ulLatencyNs = ulLatencyNs;
+}
+
+
+
+/*****************************************************************************
+ * Function: vTimingIsrExit()
+ *//**
+ *
+ * @brief	Called at the end of a timer task release (interrupt context).
+ *
+******************************************************************************/
+
+static void vTimingIsrExit(TaskTiming_s *pxTiming)
+{
+	XTime xNow;
+
+	XTime_GetTime(&xNow);
+	pxTiming->xIsrExit = xNow;
+}
+
+
+
+/*****************************************************************************
+ * Function: vTimingTaskWoken()
+ *//**
+ *
+ * @brief	Called by a timer task as soon as it is released. Takes a copy of
+ * 			the interrupt-side times, so that a release that comes in while
+ * 			the task is still running does not mix with this one.
+ *
+******************************************************************************/
+
+static void vTimingTaskWoken(TaskTiming_s *pxTiming)
+{
+	XTime_GetTime(&pxTiming->xWake);
+
+	taskENTER_CRITICAL();
+	pxTiming->xEntry = pxTiming->xIsrEntry;
+	pxTiming->xExit = pxTiming->xIsrExit;
+	pxTiming->ulLatency = pxTiming->ulLatencyNs;
+	taskEXIT_CRITICAL();
+}
+
+
+
+/*****************************************************************************
+ * Function: vTimingTaskDone()
+ *//**
+ *
+ * @brief	Called by a timer task when its work for the release is done.
+ * 			Adds the release to the histograms (TimingMetric_t).
+ *
+******************************************************************************/
+
+static void vTimingTaskDone(TaskTiming_s *pxTiming)
+{
+	XTime xDone;
+	uint32_t ulLatency = pxTiming->ulLatency;
+
+	XTime_GetTime(&xDone);
+
+	vTimingHistAdd(&pxTiming->xHist[eTimingIrqLatency], ulLatency);
+	vTimingHistAdd(&pxTiming->xHist[eTimingIsrExit],
+					ulLatency + TIMING_COUNTS_TO_NS(pxTiming->xExit - pxTiming->xEntry));
+	vTimingHistAdd(&pxTiming->xHist[eTimingRelease],
+					ulLatency + TIMING_COUNTS_TO_NS(pxTiming->xWake - pxTiming->xEntry));
+	vTimingHistAdd(&pxTiming->xHist[eTimingResponse],
+					ulLatency + TIMING_COUNTS_TO_NS(xDone - pxTiming->xEntry));
+}
+#endif /* TIMER_TASK_TIMING */
+
+
+
 
 /*============================================*/
 /* ======== MISCELLANEOUS FUNCTIONS ==========*/
@@ -757,24 +3026,29 @@ void vLowLevelSysInit(void)
 
 
 	/* Keep track of initialisation using this struct */
-	LowLevelInitStatus_s LowLevelInitStatus = { .uart1 = XST_FAILURE,
+	LowLevelInitStatus_s LowLevelInitStatus = { .uart0 = XST_FAILURE,
+												.uart1 = XST_FAILURE,
 												.xgpio0 = XST_FAILURE,
 												.xgpio1 = XST_FAILURE,
 												.xgpiops = XST_FAILURE,
 												.xscu_gic = XST_FAILURE,
 												.xttc0_0 = XST_FAILURE,
-												.xttc0_1 = XST_FAILURE
+												.xttc0_1 = XST_FAILURE,
+												.xdma = XST_FAILURE
 	};
 
 
 	/* ===== Initialization =====
 	 * (1) SCU GIC
-	 * (2) PS7 UART0 (also needs reference to GIC to initialise interrupts).
+	 * (2) PS7 UART1 and, if it is a command channel, UART0 (also need reference to GIC to initialise interrupts).
 	 * (3) AXI GPIO 0
 	 * (4) AXI GPIO 1
 	 * (5) AXI PS7 GPIO
-	 * (6) TTC0-0 (also needs reference to GIC to initialise interrupts).
-	 * (7) TTC0-1 (also needs reference to GIC to initialise interrupts).
+	 * (6) TTC0-0 (also needs reference to GIC to initialise interrupts);
+	 *     with TTC_MATCH_SERVICE, as the match service for both timer tasks.
+	 * (7) TTC0-1 (also needs reference to GIC to initialise interrupts);
+	 *     not used with TTC_MATCH_SERVICE.
+	 * (8) PS7 DMA (also needs reference to GIC to initialise interrupts).
 	 */
 
 #if PRINT_INIT_STATUS_TO_TERMINAL
@@ -783,11 +3057,45 @@ void vLowLevelSysInit(void)
 
 	LowLevelInitStatus.xscu_gic = xScuGicInit(&xInterruptController);
 	LowLevelInitStatus.uart1 = xUartPs1Init(&xUartPs1Inst, &xInterruptController);
+#if UART0_CMD_CHANNEL
+	LowLevelInitStatus.uart0 = xUartPs0Init(&xUartPs0Inst, &xInterruptController);
+#else
+	LowLevelInitStatus.uart0 = XST_SUCCESS;		// Console only, set up by the BSP
+#endif
 	LowLevelInitStatus.xgpio0 = axiGpio0Init();
 	LowLevelInitStatus.xgpio1 = axiGpio1Init();
 	LowLevelInitStatus.xgpiops = psGpioInit();
-	LowLevelInitStatus.xttc0_0 = xTtcInit(0, &xTtc0_0_Inst, &xInterruptController, vTtc0_0_IntrHandler);
-	LowLevelInitStatus.xttc0_1 = xTtcInit(1, &xTtc0_1_Inst, &xInterruptController, vTtc0_1_IntrHandler);
+#if TTC_MATCH_SERVICE
+	LowLevelInitStatus.xttc0_0 = xTtcMatchInit(0, &xTtcMatchService, &xTtc0_0_Inst, &xInterruptController);
+	if (LowLevelInitStatus.xttc0_0 == XST_SUCCESS)
+	{
+		LowLevelInitStatus.xttc0_0 = xTtcMatchAddEvent(&xTtcMatchService, TTC0_0_PERIOD_NS,
+														vPeriodicTimerTask1Release, NULL);
+	}
+	if (LowLevelInitStatus.xttc0_0 == XST_SUCCESS)
+	{
+		LowLevelInitStatus.xttc0_0 = xTtcMatchAddEvent(&xTtcMatchService, TTC0_1_PERIOD_NS,
+														vPeriodicTimerTask2Release, NULL);
+	}
+	LowLevelInitStatus.xttc0_1 = XST_SUCCESS;	// Not used
+#else
+	/* The interrupts are connected to the deferred interrupt layer, which wakes the timer tasks. */
+	LowLevelInitStatus.xttc0_0 = xTtcInit(0, &xTtc0_0_Inst, &xInterruptController, NULL);
+	if (LowLevelInitStatus.xttc0_0 == XST_SUCCESS)
+	{
+		LowLevelInitStatus.xttc0_0 = xDeferredIrqConnect(&xPeriodTimerTask1Irq, &xInterruptController,
+														TTC0_0_INT_ID, TTC_INTR_PRI, TTC_INTR_TRIG,
+														ulTtc0_0_IntrAck, &xTtc0_0_Inst);
+	}
+	LowLevelInitStatus.xttc0_1 = xTtcInit(1, &xTtc0_1_Inst, &xInterruptController, NULL);
+	if (LowLevelInitStatus.xttc0_1 == XST_SUCCESS)
+	{
+		LowLevelInitStatus.xttc0_1 = xDeferredIrqConnect(&xPeriodTimerTask2Irq, &xInterruptController,
+														TTC0_1_INT_ID, TTC_INTR_PRI, TTC_INTR_TRIG,
+														ulTtc0_1_IntrAck, &xTtc0_1_Inst);
+	}
+#endif
+	LowLevelInitStatus.xdma = xDmaPsInit(&xDmaPsInst, &xInterruptController);
 
 
 
@@ -797,7 +3105,7 @@ void vLowLevelSysInit(void)
 	if (LowLevelInitStatus.xscu_gic != XST_SUCCESS) 	{ printf("Error detected.\n\r"); }
 	else												{ printf("Success.\n\r"); }
 
-	printf("UART0 initialization: ");
+	printf("UART1 initialization: ");
 	if (LowLevelInitStatus.uart1 != XST_SUCCESS) 		{ printf("Error detected.\n\r"); }
 	else												{ printf("Success.\n\r"); }
 
@@ -813,12 +3121,22 @@ void vLowLevelSysInit(void)
 	if (LowLevelInitStatus.xgpiops != XST_SUCCESS) 		{ printf("Error detected.\n\r"); }
 	else												{ printf("Success.\n\r"); }
 
+#if TTC_MATCH_SERVICE
+	printf("TTC0-0 match service initialization: ");
+	if (LowLevelInitStatus.xttc0_0 != XST_SUCCESS) 		{ printf("Error detected.\n\r"); }
+	else												{ printf("Success.\n\r"); }
+#else
 	printf("TTC0-0 initialization: ");
 	if (LowLevelInitStatus.xttc0_0 != XST_SUCCESS) 		{ printf("Error detected.\n\r"); }
 	else												{ printf("Success.\n\r"); }
 
 	printf("TTC0-1 initialization: ");
-	if (LowLevelInitStatus.xttc0_1 != XST_SUCCESS) 		{ printf("Error detected.\n\r\n\r"); }
+	if (LowLevelInitStatus.xttc0_1 != XST_SUCCESS) 		{ printf("Error detected.\n\r"); }
+	else												{ printf("Success.\n\r"); }
+#endif
+
+	printf("PS7 DMA initialization: ");
+	if (LowLevelInitStatus.xdma != XST_SUCCESS) 		{ printf("Error detected.\n\r\n\r"); }
 	else												{ printf("Success.\n\r\n\r"); }
 #endif
 
@@ -828,12 +3146,14 @@ void vLowLevelSysInit(void)
 	/* --- CHECK INITIALISATION STATUS ---*/
 
 	int init_status = ( (LowLevelInitStatus.xscu_gic == XST_SUCCESS) &&
+						(LowLevelInitStatus.uart0 == XST_SUCCESS) &&
 						(LowLevelInitStatus.uart1 == XST_SUCCESS) &&
 						(LowLevelInitStatus.xgpio0 == XST_SUCCESS) &&
 						(LowLevelInitStatus.xgpio1 == XST_SUCCESS) &&
 						(LowLevelInitStatus.xgpiops == XST_SUCCESS) &&
 						(LowLevelInitStatus.xttc0_0 == XST_SUCCESS) &&
-						(LowLevelInitStatus.xttc0_1 == XST_SUCCESS)
+						(LowLevelInitStatus.xttc0_1 == XST_SUCCESS) &&
+						(LowLevelInitStatus.xdma == XST_SUCCESS)
 						);
 
 
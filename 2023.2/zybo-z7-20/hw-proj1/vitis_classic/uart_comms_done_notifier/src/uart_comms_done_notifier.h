@@ -34,6 +34,65 @@
 // Print info:
 #define PRINT_INIT_STATUS_TO_TERMINAL		1
 
+// Command channels:
+/* 1 = UART0 (PMOD JB) is a second command channel next to UART1, e.g. for a
+ * production tester, which must be wired to PMOD JB. UART0 is also the stdout
+ * console, so all console output (including the init status) is turned off.
+ * 0 = UART1 only, console on UART0. */
+#define UART0_CMD_CHANNEL					0
+
+/* Deferred log (see utilities/dlog.h). 1 => the host reads the binary records
+ * with CMD_READ_LOG and formats them itself; 0 => the Log Formatter task
+ * prints them on the console. Must be 1 while UART0 carries commands. */
+#define DLOG_HOST_DECODE					UART0_CMD_CHANNEL
+
+/* Framing of each command channel.
+ * RAW:  64-byte frames, or long frames of the size given in their header, as
+ *       sent by the original host software. After a lost or extra byte the
+ *       receiver only gets back in step when the line goes idle.
+ * COBS: each frame (64-byte or long) is COBS-encoded and ends with a 0x00
+ *       delimiter, in both directions (see utilities/cobs.h). The receiver
+ *       gets back in step at the next delimiter. Needs UART1_RX_STREAMING.
+ * The two are not compatible on the wire: RAW is the default so that existing
+ * hosts keep working, and a channel is switched to COBS only together with
+ * the host software that talks to it. */
+#define CMD_FRAMING_RAW						0
+#define CMD_FRAMING_COBS					1
+
+#define UART1_CMD_FRAMING					CMD_FRAMING_RAW
+#define UART0_CMD_FRAMING					CMD_FRAMING_RAW
+
+/* UART interrupt handling on the command channels (streaming mode only).
+ * 1 = register-level handler: one status read, the RX FIFO drained in bulk
+ *     straight into the Rx ring and the TX FIFO refilled in bulk.
+ * 0 = Xilinx driver (XUartPs_InterruptHandler -> vUartIntrHandlerForQueue),
+ *     which checks the status register for every byte.
+ * CMD_GET_ISR_STATS reports the handler time either way. */
+#define UART_CMD_FAST_ISR					1
+
+/* Loopback self-benchmark (see vLoopbackBenchTask). 1 = UART1 runs in local
+ * loopback mode, so no host can use it, and a bench task pumps generated
+ * frames through the whole command path (ISR, Rx ring and task, worker, Tx
+ * task) and back. With UART1 in loopback, the results can only be read over a
+ * UART with CMD_GET_BENCH_RESULT on UART0, which needs UART0_CMD_CHANNEL 1.
+ * Otherwise they are only printed on the console, as "BENCH" lines (when
+ * DLOG_HOST_DECODE is 0, which it is with UART0_CMD_CHANNEL 0).
+ * Nothing outside the Zynq is needed, so it also runs on the QEMU Zynq
+ * machine, whose UART model implements the loopback mode. */
+#define UART1_LOOPBACK_BENCH				0
+
+/* Periodic timer task releases.
+ * 1 = both tasks are released by the match-register service on TTC0-0 (one
+ *     free-running counter, one interrupt line; TTC0-1 stays free).
+ * 0 = one TTC counter in interval mode per task (TTC0-0 and TTC0-1). */
+#define TTC_MATCH_SERVICE					1
+
+/* Timer task timing. 1 = each release of the periodic timer tasks is
+ * timestamped on the global timer (TTC event, ISR entry and exit, task wake-up
+ * and task done) and collected in histograms, read with CMD_GET_TIMING_STATS
+ * and CMD_GET_TIMING_HIST. The PMOD_JE test signals are kept either way. */
+#define TIMER_TASK_TIMING					1
+
 
 /*****************************************************************************/
 /***************************** Include Files *********************************/
@@ -65,9 +124,11 @@ typedef struct {
 	volatile int xgpio1;
 	volatile int xgpiops;
 	volatile int xscu_gic;
+	volatile int uart0;
 	volatile int uart1;
 	volatile int xttc0_0;
 	volatile int xttc0_1;
+	volatile int xdma;
 } LowLevelInitStatus_s;
 
 
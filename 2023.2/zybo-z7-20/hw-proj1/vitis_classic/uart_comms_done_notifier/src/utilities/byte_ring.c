@@ -0,0 +1,134 @@
+/******************************************************************************
+ * @Title		:	Byte Ring Buffer
+ * @Filename	:	byte_ring.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "byte_ring.h"
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		xByteRingInit()
+*
+* Description:	Initialises an empty ring on the given buffer.
+*
+* param[in]		*p_ring: Ring to initialise.
+* param[in]		*p_buffer: Storage for the ring.
+* param[in]		size: Size of the buffer in bytes (power of two).
+*
+* Returns:		XST_SUCCESS, or XST_FAILURE if the size is not a power of two.
+*
+* Notes:		Call before the producer and consumer start.
+*
+****************************************************************************/
+
+int xByteRingInit(ByteRing_s *p_ring, uint8_t *p_buffer, uint32_t size)
+{
+	if ( (p_buffer == NULL) || (size == 0U) || ((size & (size - 1U)) != 0U) )
+	{
+		return XST_FAILURE;
+	}
+
+	p_ring->pucBuffer = p_buffer;
+	p_ring->ulSize = size;
+	p_ring->ulHead = 0U;
+	p_ring->ulTail = 0U;
+	p_ring->ulHighWater = 0U;
+
+	return XST_SUCCESS;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulByteRingWrite()
+*
+* Description:	Copies bytes into the ring (producer side).
+*
+* param[in]		*p_ring: Ring to write to.
+* param[in]		*p_src: Bytes to copy.
+* param[in]		len: Number of bytes to copy.
+*
+* Returns:		Number of bytes copied; less than len if the ring is full.
+*
+* Notes:		For producers that already hold the data in a buffer. A
+* 				producer that reads a device can write straight into the
+* 				region from pucByteRingWriteRegion() instead.
+*
+****************************************************************************/
+
+uint32_t ulByteRingWrite(ByteRing_s *p_ring, const uint8_t *p_src, uint32_t len)
+{
+	uint8_t *p_dst;
+	uint32_t region;
+	uint32_t copied = 0U;
+
+	/* At most two regions: up to the end of the buffer, then from the start. */
+	while (copied < len)
+	{
+		p_dst = pucByteRingWriteRegion(p_ring, &region);
+		if (region == 0U)
+		{
+			break;
+		}
+
+		if (region > (len - copied))
+		{
+			region = len - copied;
+		}
+
+		memcpy(p_dst, &p_src[copied], region);
+		vByteRingProduce(p_ring, region);
+		copied += region;
+	}
+
+	return copied;
+}
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
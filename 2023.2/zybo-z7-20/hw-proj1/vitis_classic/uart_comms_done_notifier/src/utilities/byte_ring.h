@@ -0,0 +1,139 @@
+/******************************************************************************
+ * @Title		:	Byte Ring Buffer (Header File)
+ * @Filename	:	byte_ring.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+#ifndef SRC_UTILITIES_BYTE_RING_H_
+#define SRC_UTILITIES_BYTE_RING_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+/* Single-producer/single-consumer byte ring, e.g. UART ISR -> task. No lock
+ * is needed: ulHead is only written by the producer and ulTail only by the
+ * consumer. Both are free-running byte counts (the buffer index is the count
+ * modulo ulSize), so a full ring and an empty ring are told apart without a
+ * spare byte. ulSize must be a power of two.
+ *
+ * The producer and consumer work on the buffer in place: they ask for the
+ * contiguous region they may write (or read), access it directly, then
+ * publish the number of bytes with vByteRingProduce() (or
+ * vByteRingConsume()). */
+typedef struct {
+	uint8_t				*pucBuffer;
+	uint32_t			ulSize;			// Buffer size in bytes (power of two)
+	volatile uint32_t	ulHead;			// Bytes written (producer)
+	volatile uint32_t	ulTail;			// Bytes read (consumer)
+	uint32_t			ulHighWater;	// Most bytes held at once (producer)
+} ByteRing_s;
+
+
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+/* The head/tail loads and stores have acquire/release ordering (a DMB on the
+ * Cortex-A9), so the bytes are in the buffer before the other side sees the
+ * new count, and are not overwritten before they have been read. */
+
+/* Number of bytes in the ring. Either side may call this. */
+static inline uint32_t ulByteRingUsed(const ByteRing_s *p_ring)
+{
+	return __atomic_load_n(&p_ring->ulHead, __ATOMIC_ACQUIRE) -
+		   __atomic_load_n(&p_ring->ulTail, __ATOMIC_ACQUIRE);
+}
+
+/* Producer: contiguous free region. *p_len = 0 if the ring is full. */
+static inline uint8_t *pucByteRingWriteRegion(const ByteRing_s *p_ring, uint32_t *p_len)
+{
+	uint32_t head = p_ring->ulHead;
+	uint32_t index = head & (p_ring->ulSize - 1U);
+	uint32_t space = p_ring->ulSize - (head - __atomic_load_n(&p_ring->ulTail, __ATOMIC_ACQUIRE));
+
+	*p_len = (space < (p_ring->ulSize - index)) ? space : (p_ring->ulSize - index);
+	return &p_ring->pucBuffer[index];
+}
+
+/* Producer: publishes 'len' bytes written to the write region. */
+static inline void vByteRingProduce(ByteRing_s *p_ring, uint32_t len)
+{
+	uint32_t head = p_ring->ulHead + len;
+	uint32_t used = head - p_ring->ulTail;
+
+	__atomic_store_n(&p_ring->ulHead, head, __ATOMIC_RELEASE);
+
+	if (used > p_ring->ulHighWater)
+	{
+		p_ring->ulHighWater = used;
+	}
+}
+
+/* Consumer: contiguous region of unread bytes. *p_len = 0 if the ring is empty. */
+static inline const uint8_t *pucByteRingReadRegion(const ByteRing_s *p_ring, uint32_t *p_len)
+{
+	uint32_t tail = p_ring->ulTail;
+	uint32_t index = tail & (p_ring->ulSize - 1U);
+	uint32_t used = __atomic_load_n(&p_ring->ulHead, __ATOMIC_ACQUIRE) - tail;
+
+	*p_len = (used < (p_ring->ulSize - index)) ? used : (p_ring->ulSize - index);
+	return &p_ring->pucBuffer[index];
+}
+
+/* Consumer: releases 'len' bytes of the read region. */
+static inline void vByteRingConsume(ByteRing_s *p_ring, uint32_t len)
+{
+	__atomic_store_n(&p_ring->ulTail, p_ring->ulTail + len, __ATOMIC_RELEASE);
+}
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Initialises an empty ring on the given buffer. Returns XST_FAILURE if the
+ * size is not a power of two. */
+int xByteRingInit(ByteRing_s *p_ring, uint8_t *p_buffer, uint32_t size);
+
+/* Producer: copies up to 'len' bytes into the ring. Returns the number of
+ * bytes copied (less than 'len' if the ring is full). */
+uint32_t ulByteRingWrite(ByteRing_s *p_ring, const uint8_t *p_src, uint32_t len);
+
+
+#endif /* SRC_UTILITIES_BYTE_RING_H_ */
@@ -29,30 +29,42 @@
 
 
 
+
+
 /*****************************************************************************/
 /***************************** Include Files *********************************/
 /*****************************************************************************/
 
+#include <string.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "cmd_handler64B.h"
+#include "crc32.h"
 
 
 
 
-/* Array to store the write data values for sequential write command. */
-static uint32_t write_resp[16] = {	WRITE_OKAY, WRITE_OKAY, WRITE_OKAY,
-									WRITE_OKAY, WRITE_OKAY, WRITE_OKAY,
-									WRITE_OKAY, WRITE_OKAY, WRITE_OKAY,
-									WRITE_OKAY, WRITE_OKAY, WRITE_OKAY,
-									WRITE_OKAY, WRITE_OKAY, WRITE_OKAY,
-									WRITE_OKAY };
+/* Whole-frame responses, stored in wire (big-endian) byte order so that they
+ * can be block-copied straight into the transmit buffer. */
+static const uint32_t write_resp[CMD_FRAME_WORDS] = {
+		CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY),
+		CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY),
+		CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY),
+		CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY),
+		CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY), CMD_BSWAP32(WRITE_OKAY),
+		CMD_BSWAP32(WRITE_OKAY) };
 
 
-static uint32_t cmd_error_resp[16] = {	CMD_ERROR, CMD_ERROR, CMD_ERROR,
-										CMD_ERROR, CMD_ERROR, CMD_ERROR,
-										CMD_ERROR, CMD_ERROR, CMD_ERROR,
-										CMD_ERROR, CMD_ERROR, CMD_ERROR,
-										CMD_ERROR, CMD_ERROR, CMD_ERROR,
-										CMD_ERROR };
+static const uint32_t cmd_error_resp[CMD_FRAME_WORDS] = {
+		CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR),
+		CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR),
+		CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR),
+		CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR),
+		CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR), CMD_BSWAP32(CMD_ERROR),
+		CMD_BSWAP32(CMD_ERROR) };
 
 
 
@@ -60,9 +72,9 @@ static uint32_t cmd_error_resp[16] = {	CMD_ERROR, CMD_ERROR, CMD_ERROR,
 /************************** Variable Declarations ****************************/
 /*****************************************************************************/
 
-/* Store cmd and data fields of received data in this structure */
-static cmd_frame		CmdFrameInst;
-static cmd_frame 		*p_cmd_frame = &CmdFrameInst;
+/* Instance used by the single-channel interface (handleCommand64B() etc.).
+ * Nothing else in the command handler keeps per-frame state. */
+static CmdHandlerCtx_s	DefaultCtx = { .Frame = { .p_ctx = &DefaultCtx } };
 
 
 
@@ -71,9 +83,71 @@ static cmd_frame 		*p_cmd_frame = &CmdFrameInst;
 /****************************************************************************/
 
 /* Functions internal to the command handler */
-static void decodeRxData(uint8_t *rx_buffer);
-static void executeCommand(uint8_t *tx_buffer);
-static void setResponseBytes(uint8_t *tx_buffer, uint32_t tx_data);
+static int decodeRxData(CmdHandlerCtx_s *p_ctx, uint8_t *rx_buffer, uint32_t rx_len, uint32_t tx_max);
+static uint32_t executeCommand(CmdHandlerCtx_s *p_ctx, uint8_t *tx_buffer);
+static int xCheckCommand(const CmdTableEntry_s *p_entry, const cmd_frame *p_frame);
+static uint32_t finishResponse(const cmd_frame *p_cmd_frame, uint8_t *tx_buffer, uint32_t resp_words);
+static uint32_t setErrorResponse(const cmd_frame *p_cmd_frame, uint8_t *tx_buffer);
+static uint32_t setCrcErrorResponse(uint8_t *tx_buffer);
+static const uint8_t *pListWords(const cmd_frame *p_frame, uint32_t *p_list_words);
+static int xCheckAddrList(const uint8_t *p_list, uint32_t entries, uint32_t stride);
+
+/* Built-in command execution functions */
+static uint32_t cmdWriteWord(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdReadWord(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdWriteSequential(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdReadSequential(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdNegotiateFrame(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdBatch(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdReadModifyWrite(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdMaskedWrite(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdPollUntil(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdGatherRead(const cmd_frame *p_frame, uint8_t *tx_data);
+static uint32_t cmdScatterWrite(const cmd_frame *p_frame, uint8_t *tx_data);
+
+
+
+/*****************************************************************************/
+/***************************** Command Table *********************************/
+/*****************************************************************************/
+
+/* Indexed by CMD_TABLE_INDEX(cmd). The built-in commands are placed at compile
+ * time; applications add their own with xCmdHandlerRegister(). */
+static CmdTableEntry_s CmdTable[CMD_TABLE_SIZE] = {
+
+	[CMD_TABLE_INDEX(WRITE_WORD)] =
+		{ WRITE_WORD, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED | CMD_FLAG_BATCHABLE, cmdWriteWord },
+
+	[CMD_TABLE_INDEX(READ_WORD)] =
+		{ READ_WORD, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED | CMD_FLAG_BATCHABLE, cmdReadWord },
+
+	[CMD_TABLE_INDEX(WRITE_SEQUENTIAL)] =
+		{ WRITE_SEQUENTIAL, 1U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED | CMD_FLAG_SZ_DATA, cmdWriteSequential },
+
+	[CMD_TABLE_INDEX(READ_SEQUENTIAL)] =
+		{ READ_SEQUENTIAL, 1U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED | CMD_FLAG_SZ_RESP, cmdReadSequential },
+
+	[CMD_TABLE_INDEX(NEGOTIATE_FRAME)] =
+		{ NEGOTIATE_FRAME, 0U, 0xFFFFU, CMD_FLAG_NONE, cmdNegotiateFrame },
+
+	[CMD_TABLE_INDEX(BATCH)] =
+		{ BATCH, 1U, 0xFFFFU, CMD_FLAG_NONE, cmdBatch },
+
+	[CMD_TABLE_INDEX(READ_MODIFY_WRITE)] =
+		{ READ_MODIFY_WRITE, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED, cmdReadModifyWrite },
+
+	[CMD_TABLE_INDEX(MASKED_WRITE)] =
+		{ MASKED_WRITE, 0U, 0xFFFFU, CMD_FLAG_ADDR_ALIGNED, cmdMaskedWrite },
+
+	[CMD_TABLE_INDEX(POLL_UNTIL)] =
+		{ POLL_UNTIL, CMD_POLL_EQUAL, CMD_POLL_NOT_EQUAL, CMD_FLAG_ADDR_ALIGNED, cmdPollUntil },
+
+	[CMD_TABLE_INDEX(GATHER_READ)] =
+		{ GATHER_READ, 1U, 0xFFFFU, CMD_FLAG_SZ_RESP, cmdGatherRead },
+
+	[CMD_TABLE_INDEX(SCATTER_WRITE)] =
+		{ SCATTER_WRITE, 1U, 0xFFFFU, CMD_FLAG_NONE, cmdScatterWrite },
+};
 
 
 
@@ -83,6 +157,50 @@ static void setResponseBytes(uint8_t *tx_buffer, uint32_t tx_data);
 
 
 
+/******************************************************************************
+*
+* Function:		vCmdHandlerInit()
+*
+* Description:	Initialises the command handler.
+*
+* Returns:		None.
+*
+* Notes:		Call once, before the first frame is handled.
+*
+****************************************************************************/
+
+void vCmdHandlerInit(void)
+{
+	vCrc32Init();
+	vCmdHandlerCtxInit(&DefaultCtx);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vCmdHandlerCtxInit()
+*
+* Description:	Initialises a command handler instance. Each channel (command
+* 				task) needs its own instance.
+*
+* param[in]		*p_ctx: Instance to initialise.
+*
+* Returns:		None.
+*
+* Notes:		Long frames are disabled until the host negotiates them on
+* 				the instance.
+*
+****************************************************************************/
+
+void vCmdHandlerCtxInit(CmdHandlerCtx_s *p_ctx)
+{
+	memset(p_ctx, 0, sizeof(*p_ctx));
+	p_ctx->Frame.p_ctx = p_ctx;
+}
+
+
+
 /******************************************************************************
 *
 * Function:		handleCommand()
@@ -96,7 +214,9 @@ static void setResponseBytes(uint8_t *tx_buffer, uint32_t tx_data);
 * Returns:		None.
 *
 * Notes:		This is the interface function that is called by external code
-* 				so that command handling is carried out.
+* 				so that command handling is carried out. Both buffers are
+* 				CMD_FRAME_SIZE bytes. Uses the default instance; tasks that
+* 				need their own channel call ulCmdHandlerProcess() instead.
 *
 ****************************************************************************/
 
@@ -104,9 +224,131 @@ void handleCommand64B(uint8_t *rx_buffer, uint8_t *tx_buffer)
 {
 
 	/* Decode the receive data and execute the command */
-	decodeRxData(rx_buffer);
-	executeCommand(tx_buffer);
+	(void)ulCmdHandlerProcess(&DefaultCtx, rx_buffer, CMD_FRAME_SIZE, tx_buffer, CMD_FRAME_SIZE);
+
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulHandleCommandFrame(), ulCmdFrameWireSize(),
+* 				ulCmdHandlerCrcErrors()
+*
+* Description:	Single-channel versions of ulCmdHandlerProcess(),
+* 				ulCmdHandlerFrameWireSize() and ulCmdHandlerCtxCrcErrors(),
+* 				using the default instance.
+*
+****************************************************************************/
+
+uint32_t ulHandleCommandFrame(uint8_t *rx_buffer, uint32_t rx_len,
+								uint8_t *tx_buffer, uint32_t tx_max)
+{
+	return ulCmdHandlerProcess(&DefaultCtx, rx_buffer, rx_len, tx_buffer, tx_max);
+}
+
+uint32_t ulCmdFrameWireSize(const uint8_t *rx_block)
+{
+	return ulCmdHandlerFrameWireSize(&DefaultCtx, rx_block);
+}
+
+uint32_t ulCmdHandlerCrcErrors(void)
+{
+	return ulCmdHandlerCtxCrcErrors(&DefaultCtx);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulCmdHandlerProcess()
+*
+* Description:	Handles a 64-byte frame or a long frame.
+*
+* param[in]		*p_ctx: Handler instance of the channel.
+* param[in]		*rx_buffer: Pointer to the received frame.
+* param[in]		rx_len: Number of bytes received.
+* param[in]		*tx_buffer: Pointer to the transmit buffer.
+* param[in]		tx_max: Size of the transmit buffer in bytes.
+*
+* Returns:		Number of bytes to transmit from tx_buffer. This is always a
+* 				multiple of CMD_FRAME_SIZE (long responses are zero-padded).
+*
+* Notes:		Frames that cannot be decoded (e.g. a long frame before one has
+* 				been negotiated) are answered with the 64-byte CMD_ERROR
+* 				response. Reentrant: different tasks may call this at the same
+* 				time with different instances.
+*
+****************************************************************************/
+
+uint32_t ulCmdHandlerProcess(CmdHandlerCtx_s *p_ctx,
+								uint8_t *rx_buffer, uint32_t rx_len,
+								uint8_t *tx_buffer, uint32_t tx_max)
+{
+
+	cmd_frame *p_cmd_frame = &p_ctx->Frame;
+
+	if (decodeRxData(p_ctx, rx_buffer, rx_len, tx_max) != XST_SUCCESS)
+	{
+		return setErrorResponse(p_cmd_frame, tx_buffer);
+	}
+
+	/* Nothing in the frame is acted on until its CRC has been checked. */
+	if ( (p_cmd_frame->has_crc != 0U) &&
+		 (ulCrc32(rx_buffer, p_cmd_frame->frame_len) != ulCmdLoadBE32(&rx_buffer[p_cmd_frame->frame_len])) )
+	{
+		p_ctx->ulCrcErrorCount++;
+		return setCrcErrorResponse(tx_buffer);
+	}
+
+	return executeCommand(p_ctx, tx_buffer);
+
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulCmdHandlerFrameWireSize()
+*
+* Description:	Works out how many bytes make up the frame that starts with
+* 				the given 64-byte block.
+*
+* param[in]		*p_ctx: Handler instance of the channel.
+* param[in]		*rx_block: Pointer to the first block of the frame.
+*
+* Returns:		CMD_FRAME_SIZE for a 64-byte frame, or the padded size of a
+* 				long frame.
+*
+* Notes:		A long frame header that is invalid (or not negotiated) is
+* 				treated as a 64-byte frame, so that it is rejected on its own
+* 				rather than swallowing the blocks that follow it.
+*
+****************************************************************************/
+
+uint32_t ulCmdHandlerFrameWireSize(const CmdHandlerCtx_s *p_ctx, const uint8_t *rx_block)
+{
+	uint32_t cmd_raw = ulCmdLoadBE32(rx_block) >> 16;
+	uint32_t len;
+	uint32_t crc_size;
+
+	if ( (cmd_raw & CMD_LONG_FRAME) == 0U )
+	{
+		return CMD_FRAME_SIZE;
+	}
+
+	len = ulCmdLoadBE32(&rx_block[8]);
+	crc_size = (cmd_raw & CMD_CRC_FRAME) ? CMD_CRC_SIZE : 0U;
+
+	/* len comes off the wire: compared without adding to it, so that a
+	 * length near 2^32 cannot wrap around the checks. */
+	if ( (p_ctx->ulLongFrameMax < crc_size + CMD_LONG_HDR_SIZE) || (len < CMD_LONG_HDR_SIZE) ||
+		 (len > p_ctx->ulLongFrameMax - crc_size) )
+	{
+		return CMD_FRAME_SIZE;
+	}
 
+	return CMD_FRAME_WIRE_SIZE(len + crc_size);
 }
 
 
@@ -116,253 +358,787 @@ void handleCommand64B(uint8_t *rx_buffer, uint8_t *tx_buffer)
 * Function:		decodeRxData
 *
 * Description:	Decodes the received data and converts it to a 'cmd_frame'
-* 				structure. Updates 'CmdFrameInst' using the pointer *p_cmd_frame.
+* 				structure. Updates the instance's 'Frame'.
 *
+* param[in]		*p_ctx: Handler instance of the channel.
 * param[in]		*rx_buffer: Pointer to the receive buffer in the comms block.
+* param[in]		rx_len: Number of bytes received.
+* param[in]		tx_max: Size of the transmit buffer in bytes.
 *
-* Returns:		None.
+* Returns:		XST_SUCCESS, or XST_FAILURE if the frame is not valid.
+*
+* Notes:		The frame is decoded in a single pass of word loads, each
+* 				followed by a byte-reverse (big-endian wire format). Every
+* 				field is overwritten, so nothing carries over between frames.
+* 				The data words of a long frame are left in the receive buffer
+* 				(see p_data); only the first 14 are copied to field2-field15.
+* 				The CRC itself is checked by the caller (see frame_len).
+*
+****************************************************************************/
+
+int decodeRxData(CmdHandlerCtx_s *p_ctx, uint8_t *rx_buffer, uint32_t rx_len, uint32_t tx_max){
+
+	cmd_frame *p_cmd_frame = &p_ctx->Frame;
+	uint32_t idx;
+	uint32_t word;
+	uint32_t len;
+	uint32_t frame_max;
+	uint32_t crc_size;
+
+	/* The flags are cleared first so that a rejected frame gets a 64-byte
+	 * error response. */
+	p_cmd_frame->is_long = 0U;
+	p_cmd_frame->has_crc = 0U;
+
+	if (rx_len < CMD_FRAME_SIZE)
+	{
+		return XST_FAILURE;
+	}
+
+	/* ------ Word 0: command (bytes 0-1) and size (bytes 2-3) ------- */
+	word = ulCmdLoadBE32(rx_buffer);
+	p_cmd_frame->cmd = (uint16_t)(word >> 16) & (uint16_t)(~(CMD_LONG_FRAME | CMD_CRC_FRAME));
+	p_cmd_frame->sz = (uint16_t)(word & 0xFFFFU);
+	crc_size = ((word >> 16) & CMD_CRC_FRAME) ? CMD_CRC_SIZE : 0U;
+
+	/* ------ Word 1: field1 (bytes 4-7) ------- */
+	p_cmd_frame->field1 = ulCmdLoadBE32(&rx_buffer[4]);
+
+
+	/* ------ 64-byte frame: words 2-15 are field2 (bytes 8-11) to field15 (bytes 60-63) ------- */
+	if ( ((word >> 16) & CMD_LONG_FRAME) == 0U )
+	{
+		for (idx = 1; idx < CMD_FRAME_FIELDS; idx++){
+			p_cmd_frame->fields[idx] = ulCmdLoadBE32(&rx_buffer[4U + (4U * idx)]);
+		}
+
+		p_cmd_frame->p_data = &rx_buffer[8];
+		p_cmd_frame->data_words = (CMD_FRAME_SIZE - 8U - crc_size) / 4U;
+		p_cmd_frame->resp_words = (CMD_FRAME_SIZE - crc_size) / 4U;
+		p_cmd_frame->frame_len = CMD_FRAME_SIZE - crc_size;
+		p_cmd_frame->has_crc = (crc_size != 0U);
+
+		return XST_SUCCESS;
+	}
+
+
+	/* ------ Long frame: check the length against the negotiated size ------- */
+	len = ulCmdLoadBE32(&rx_buffer[8]);
+	frame_max = (p_ctx->ulLongFrameMax < tx_max) ? p_ctx->ulLongFrameMax : tx_max;
+	frame_max &= ~(CMD_FRAME_SIZE - 1U);
+
+	/* frame_max (a multiple of CMD_FRAME_SIZE) and rx_len (checked above) are
+	 * at least CMD_FRAME_SIZE when non-zero, so the subtractions cannot wrap;
+	 * len, from the wire, is never added to. */
+	if ( (frame_max == 0U) || (len < CMD_LONG_HDR_SIZE) || (len > frame_max - crc_size) ||
+		 (len > rx_len - crc_size) || ((len & 0x3U) != 0U) )
+	{
+		return XST_FAILURE;
+	}
+
+	p_cmd_frame->is_long = 1U;
+	p_cmd_frame->has_crc = (crc_size != 0U);
+	p_cmd_frame->frame_len = len;
+	p_cmd_frame->p_data = &rx_buffer[CMD_LONG_HDR_SIZE];
+	p_cmd_frame->data_words = (len - CMD_LONG_HDR_SIZE) / 4U;
+	p_cmd_frame->resp_words = (frame_max - CMD_LONG_HDR_SIZE - crc_size) / 4U;
+
+	/* ------ field2 onwards: the first data words (zero if not present) ------- */
+	for (idx = 1; idx < CMD_FRAME_FIELDS; idx++){
+		p_cmd_frame->fields[idx] = (idx <= p_cmd_frame->data_words) ?
+				ulCmdLoadBE32(&p_cmd_frame->p_data[4U * (idx - 1U)]) : 0U;
+	}
+
+	return XST_SUCCESS;
+
+}
+
+
+
+/******************************************************************************
+*
+* Function:		executeCommand()
+*
+* Description:	Looks up the received command in the command table, checks the
+* 				frame against the table entry, and calls the command execution
+* 				function. The execution function directly updates the comms
+* 				block transmit buffer with the response data.
+*
+* param[in]		*p_ctx: Handler instance of the channel.
+* param[in]		*tx_buffer: Pointer to the transmit buffer in the comms block.
+*
+* Returns:		Number of bytes to transmit.
+*
+* Notes:		Unknown commands, and frames that fail validation, are answered
+* 				with the CMD_ERROR response.
+*
+****************************************************************************/
+
+uint32_t executeCommand(CmdHandlerCtx_s *p_ctx, uint8_t *tx_buffer) {
+
+	const cmd_frame *p_cmd_frame = &p_ctx->Frame;
+	const CmdTableEntry_s *p_entry = &CmdTable[CMD_TABLE_INDEX(p_cmd_frame->cmd)];
+	uint8_t *tx_data = p_cmd_frame->is_long ? &tx_buffer[CMD_LONG_HDR_SIZE] : tx_buffer;
+	uint32_t resp_words;
+
+
+	/* ----- Look up and validate the command ----- */
+	if (xCheckCommand(p_entry, p_cmd_frame) != XST_SUCCESS)
+	{
+		return setErrorResponse(p_cmd_frame, tx_buffer);
+	}
+
+
+	/* ----- Execute the command ----- */
+	resp_words = p_entry->fp_handler(p_cmd_frame, tx_data);
+
+	if (resp_words == CMD_HANDLER_ERROR)
+	{
+		return setErrorResponse(p_cmd_frame, tx_buffer);
+	}
+
+	return finishResponse(p_cmd_frame, tx_buffer, resp_words);
+
+}
+
+
+
+/******************************************************************************
+*
+* Function:		xCheckCommand()
+*
+* Description:	Checks a decoded frame (or BATCH sub-command) against its
+* 				command table entry.
+*
+* param[in]		*p_entry: Command table entry for the command.
+* param[in]		*p_frame: Decoded frame.
+*
+* Returns:		XST_SUCCESS if the command can be executed, else XST_FAILURE.
+*
+* Notes:		None.
+*
+****************************************************************************/
+
+static int xCheckCommand(const CmdTableEntry_s *p_entry, const cmd_frame *p_frame)
+{
+	if ( (p_entry->fp_handler == NULL) ||
+		 (p_entry->cmd != p_frame->cmd) ||
+		 (p_frame->sz < p_entry->min_sz) ||
+		 (p_frame->sz > p_entry->max_sz) ||
+		 ( (p_entry->flags & CMD_FLAG_ADDR_ALIGNED) && (p_frame->field1 & 0x3U) ) ||
+		 ( (p_entry->flags & CMD_FLAG_SZ_DATA) && (p_frame->sz > p_frame->data_words) ) ||
+		 ( (p_entry->flags & CMD_FLAG_SZ_RESP) && (p_frame->sz > p_frame->resp_words) ) )
+	{
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		finishResponse()
+*
+* Description:	Completes the response once the command execution function has
+* 				written its data words: adds the long frame header and the CRC
+* 				if needed, and zero-pads the response to its wire size.
+*
+* param[in]		*p_cmd_frame: Frame being answered.
+* param[in]		*tx_buffer: Pointer to the transmit buffer in the comms block.
+* param[in]		resp_words: Number of response data words written.
+*
+* Returns:		Number of bytes to transmit.
 *
-* Notes:
+* Notes:		None.
 *
 ****************************************************************************/
 
-void decodeRxData(uint8_t *rx_buffer){
+static uint32_t finishResponse(const cmd_frame *p_cmd_frame, uint8_t *tx_buffer, uint32_t resp_words)
+{
+	uint32_t len;
+	uint32_t wire_len;
+
+	uint32_t crc_size = p_cmd_frame->has_crc ? CMD_CRC_SIZE : 0U;
+	uint16_t cmd_raw = p_cmd_frame->cmd | (p_cmd_frame->has_crc ? CMD_CRC_FRAME : 0U);
 
-	uint32_t idx = 0;
+	if (p_cmd_frame->is_long == 0U)
+	{
+		len = 4U * resp_words;
+		wire_len = CMD_FRAME_SIZE;
 
-	/* ------ Extract command, bytes 0-1 ------- */ // COMMAND
-	for (idx = 0; idx < 2; idx++){
-		p_cmd_frame->cmd = (p_cmd_frame->cmd << 8) | (rx_buffer[idx]);
+		/* The CRC covers the whole frame up to the trailer */
+		memset(&tx_buffer[len], 0, wire_len - len);
+		len = wire_len - crc_size;
 	}
+	else
+	{
+		len = CMD_LONG_HDR_SIZE + (4U * resp_words);
+		wire_len = CMD_FRAME_WIRE_SIZE(len + crc_size);
+
+		vCmdStoreBE32(&tx_buffer[0], ((uint32_t)(cmd_raw | CMD_LONG_FRAME) << 16) | p_cmd_frame->sz);
+		vCmdStoreBE32(&tx_buffer[4], p_cmd_frame->field1);
+		vCmdStoreBE32(&tx_buffer[8], len);
 
-	/* ------ Extract size, bytes 2-3 ------- */ // E.G. NUMBER OF BYTES TO READ/WRITE
-	for (idx = 2; idx < 4; idx++){
-		p_cmd_frame->sz = (p_cmd_frame->sz << 8) | (rx_buffer[idx]);
+		memset(&tx_buffer[len], 0, wire_len - len);
 	}
 
-	/* ------- Extract field 1, bytes 4-7 ------ */ // ADDR IN MEM CMDS
-	for (idx = 4; idx < 8; idx++){
-		p_cmd_frame->field1 = (p_cmd_frame->field1 << 8) | (rx_buffer[idx]);
+	if (crc_size != 0U)
+	{
+		vCmdStoreBE32(&tx_buffer[len], ulCrc32(tx_buffer, len));
 	}
 
-	/* -------  Extract field 2, bytes 8-11 ----- */
-	for (idx = 8; idx < 12; idx++){
-		p_cmd_frame->field2 = (p_cmd_frame->field2 << 8) | (rx_buffer[idx]);
+	return wire_len;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		xCmdHandlerRegister()
+*
+* Description:	Adds a command to the command table, so that applications can
+* 				extend the command set without modifying the command handler.
+*
+* param[in]		cmd: Command opcode.
+* param[in]		min_sz, max_sz: Range of 'sz' values accepted for the command.
+* param[in]		flags: CMD_FLAG_xxx validation flags.
+* param[in]		fp_handler: Command execution function.
+*
+* Returns:		XST_SUCCESS if the command was added, XST_FAILURE if the table
+* 				slot is already used by another opcode or the arguments are
+* 				invalid.
+*
+* Notes:		Call during initialisation, before the scheduler is started.
+* 				Re-registering an opcode replaces its entry.
+*
+****************************************************************************/
+
+int xCmdHandlerRegister(uint16_t cmd, uint16_t min_sz, uint16_t max_sz,
+						uint8_t flags, CmdHandlerFn_t fp_handler)
+{
+	CmdTableEntry_s *p_entry = &CmdTable[CMD_TABLE_INDEX(cmd)];
+
+	if ( (fp_handler == NULL) || (min_sz > max_sz) || (cmd & (CMD_LONG_FRAME | CMD_CRC_FRAME)) )
+	{
+		return XST_FAILURE;
 	}
 
-	/* -------  Extract field 3, bytes 12-15 ----- */
-	for (idx = 12; idx < 16; idx++){
-		p_cmd_frame->field3 = (p_cmd_frame->field3 << 8) | (rx_buffer[idx]);
+	/* Slot is taken by a different opcode with the same low byte. */
+	if ( (p_entry->fp_handler != NULL) && (p_entry->cmd != cmd) )
+	{
+		return XST_FAILURE;
 	}
 
-	/* -------  Extract field 4, bytes 16-19 ----- */
-	for (idx = 16; idx < 20; idx++){
-		p_cmd_frame->field4 = (p_cmd_frame->field4 << 8) | (rx_buffer[idx]);
+	p_entry->cmd = cmd;
+	p_entry->min_sz = min_sz;
+	p_entry->max_sz = max_sz;
+	p_entry->flags = flags;
+	p_entry->fp_handler = fp_handler;
+
+	return XST_SUCCESS;
+}
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------ COMMAND EXECUTION FUNCTIONS ----------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+// --------------------------------------------------------------------------------- //
+// WRITE_WORD: 32-bit write to memory location
+// Field 1 = address ; Field 2 = Data
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdWriteWord(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	/* Write the data and update the response buffer */
+	Xil_Out32(p_frame->field1, p_frame->field2);
+	setResponseBytes(tx_data, WRITE_OKAY);
+	return 1U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D4: 32-bit read from memory location
+// Field 1 = address
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdReadWord(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	/* Read the data and update the response buffer */
+	setResponseBytes(tx_data, Xil_In32(p_frame->field1));
+	return 1U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D5: 32-bit write to memory locations
+// Field 1 = Start Address ; sz = Number of locations to write
+// (up to 14 in a 64-byte frame (13 with a CRC), CMD_LONG_FRAME_MAX_WORDS in a long frame)
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdWriteSequential(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t addr = p_frame->field1;
+	uint32_t idx;
+
+	// Write the data
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		Xil_Out32(addr, ulCmdLoadBE32(&p_frame->p_data[4U * idx]));
+		addr += 4;
 	}
 
-	/* -------  Extract field 5, bytes 20-23 ----- */
-	for (idx = 20; idx < 24; idx++){
-		p_cmd_frame->field5 = (p_cmd_frame->field5 << 8) | (rx_buffer[idx]);
+	// 64-byte frame: response code in all response words. Long frame: single word.
+	if (p_frame->is_long == 0U)
+	{
+		memcpy(tx_data, write_resp, 4U * p_frame->resp_words);
+		return p_frame->resp_words;
 	}
 
-	/* -------  Extract field 6, bytes 24-27 ----- */
-	for (idx = 24; idx < 28; idx++){
-		p_cmd_frame->field6 = (p_cmd_frame->field6 << 8) | (rx_buffer[idx]);
+	setResponseBytes(tx_data, WRITE_OKAY);
+	return 1U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D6: 32-bit read from memory locations
+// Field 1 = Start Address ; sz = Number of locations to read
+// (up to 16 in a 64-byte frame, CMD_LONG_FRAME_MAX_WORDS in a long frame)
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdReadSequential(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t addr = p_frame->field1;
+	uint32_t idx;
+
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		setResponseBytes(tx_data,  Xil_In32(addr));
+		addr += 4;
+		tx_data += 4;
 	}
 
-	/* -------  Extract field 7, bytes 28-31 ----- */
-	for (idx = 28; idx < 32; idx++){
-		p_cmd_frame->field7 = (p_cmd_frame->field7 << 8) | (rx_buffer[idx]);
+	return p_frame->sz;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D7: Negotiate the long frame size
+// Field 1 = Largest frame (bytes) the host can send and receive; 0 => legacy only.
+// Response: word 0 = agreed long frame size (0 => long frames disabled),
+//           word 1 = CMD_LONG_FRAME_MAX_SIZE
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdNegotiateFrame(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t frame_max = p_frame->field1;
+
+	if (frame_max > CMD_LONG_FRAME_MAX_SIZE)
+	{
+		frame_max = CMD_LONG_FRAME_MAX_SIZE;
 	}
 
-	/* -------  Extract field 8, bytes 32-35 ----- */
-	for (idx = 32; idx < 36; idx++){
-		p_cmd_frame->field8 = (p_cmd_frame->field8 << 8) | (rx_buffer[idx]);
+	/* Whole wire blocks only; a long frame no bigger than a 64-byte frame
+	 * gains nothing, so treat that as a request for legacy mode. */
+	frame_max &= ~(CMD_FRAME_SIZE - 1U);
+	if (frame_max <= CMD_FRAME_SIZE)
+	{
+		frame_max = 0U;
 	}
 
-	/* -------  Extract field 9, bytes 36-39 ----- */
-	for (idx = 36; idx < 40; idx++){
-		p_cmd_frame->field9 = (p_cmd_frame->field9 << 8) | (rx_buffer[idx]);
+	p_frame->p_ctx->ulLongFrameMax = frame_max;
+
+	setResponseBytes(&tx_data[0], frame_max);
+	setResponseBytes(&tx_data[4], CMD_LONG_FRAME_MAX_SIZE);
+	return 2U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D8: Batch of sub-commands, executed in order
+// sz = Number of records (record formats: see CMD_BATCH_REQ_SIZE in the header)
+// Response: one CMD_BATCH_RESP_SIZE record per sub-command
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdBatch(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const uint8_t *p_rec;
+	const CmdTableEntry_s *p_entry;
+	cmd_frame sub_frame;
+	uint32_t list_words;
+	uint32_t idx;
+	uint8_t status = CMD_BATCH_OK;
+
+	p_rec = pListWords(p_frame, &list_words);
+
+	if ( (p_frame->sz > (4U * list_words) / CMD_BATCH_REQ_SIZE) ||
+		 ((uint32_t)p_frame->sz * (CMD_BATCH_RESP_SIZE / 4U) > p_frame->resp_words) )
+	{
+		return CMD_HANDLER_ERROR;
 	}
 
-	/* -------  Extract field 10, bytes 40-43 ----- */
-	for (idx = 40; idx < 44; idx++){
-		p_cmd_frame->field10 = (p_cmd_frame->field10 << 8) | (rx_buffer[idx]);
+	/* Sub-commands are executed as one-word, 64-byte frames. */
+	memset(&sub_frame, 0, sizeof(sub_frame));
+	sub_frame.p_ctx = p_frame->p_ctx;
+	sub_frame.data_words = 1U;
+	sub_frame.resp_words = 1U;
+
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		tx_data[0] = p_rec[0];
+		tx_data[1] = CMD_BATCH_SKIPPED;
+		tx_data[2] = p_rec[1];
+		tx_data[3] = 0U;
+		setResponseBytes(&tx_data[4], 0U);
+
+		if (status == CMD_BATCH_OK)
+		{
+			p_entry = &CmdTable[p_rec[1]];
+
+			sub_frame.cmd = p_entry->cmd;
+			sub_frame.field1 = ulCmdLoadBE32(&p_rec[2]);
+			sub_frame.field2 = ulCmdLoadBE32(&p_rec[6]);
+			sub_frame.p_data = &p_rec[6];
+
+			if ( (p_entry->fp_handler == NULL) || ((p_entry->flags & CMD_FLAG_BATCHABLE) == 0U) )
+			{
+				status = CMD_BATCH_BAD_CMD;
+			}
+			else if ( (xCheckCommand(p_entry, &sub_frame) != XST_SUCCESS) ||
+					  (p_entry->fp_handler(&sub_frame, &tx_data[4]) == CMD_HANDLER_ERROR) )
+			{
+				status = CMD_BATCH_BAD_ARGS;
+				setResponseBytes(&tx_data[4], 0U);
+			}
+
+			tx_data[1] = status;
+		}
+
+		p_rec += CMD_BATCH_REQ_SIZE;
+		tx_data += CMD_BATCH_RESP_SIZE;
 	}
 
-	/* -------  Extract field 11, bytes 44-47 ----- */
-	for (idx = 44; idx < 48; idx++){
-		p_cmd_frame->field11 = (p_cmd_frame->field11 << 8) | (rx_buffer[idx]);
+	return (uint32_t)p_frame->sz * (CMD_BATCH_RESP_SIZE / 4U);
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00D9: Read-modify-write
+// Field 1 = address ; Field 2 = AND mask ; Field 3 = XOR mask
+// new = (old & Field 2) ^ Field 3  (set: AND ~bits, XOR bits ; clear: AND ~bits, XOR 0 ;
+// toggle: AND 0xFFFFFFFF, XOR bits)
+// Response: word 0 = old value, word 1 = value read back
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdReadModifyWrite(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t old_value;
+	uint32_t new_value;
+
+	/* No other task or (API-priority) interrupt can touch the word between
+	 * the read and the write. */
+	taskENTER_CRITICAL();
+	old_value = Xil_In32(p_frame->field1);
+	Xil_Out32(p_frame->field1, (old_value & p_frame->field2) ^ p_frame->field3);
+	new_value = Xil_In32(p_frame->field1);
+	taskEXIT_CRITICAL();
+
+	setResponseBytes(&tx_data[0], old_value);
+	setResponseBytes(&tx_data[4], new_value);
+	return 2U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00DA: Masked write
+// Field 1 = address ; Field 2 = mask ; Field 3 = value
+// Only the bits set in the mask are written: new = (old & ~mask) | (value & mask)
+// Response: word 0 = old value, word 1 = value read back
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdMaskedWrite(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	uint32_t old_value;
+	uint32_t new_value;
+
+	taskENTER_CRITICAL();
+	old_value = Xil_In32(p_frame->field1);
+	Xil_Out32(p_frame->field1, (old_value & ~p_frame->field2) | (p_frame->field3 & p_frame->field2));
+	new_value = Xil_In32(p_frame->field1);
+	taskEXIT_CRITICAL();
+
+	setResponseBytes(&tx_data[0], old_value);
+	setResponseBytes(&tx_data[4], new_value);
+	return 2U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00DB: Poll a location until it matches, or until the timeout
+// Field 1 = address ; Field 2 = mask ; Field 3 = expected value ;
+// Field 4 = timeout (ms) ; Field 5 = poll interval (ms)
+// sz = CMD_POLL_EQUAL or CMD_POLL_NOT_EQUAL
+// Response: word 0 = CMD_POLL_MATCHED / CMD_POLL_TIMEOUT, word 1 = last value read,
+//           word 2 = time taken (ms, tick resolution)
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdPollUntil(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	TickType_t xStart;
+	TickType_t xElapsed;
+	TickType_t xTimeout;
+	TickType_t xInterval;
+	uint32_t value;
+	uint32_t status;
+
+	if (p_frame->field4 > CMD_POLL_MAX_TIMEOUT_MS)
+	{
+		return CMD_HANDLER_ERROR;
 	}
 
-	/* -------  Extract field 12, bytes 48-51 ----- */
-	for (idx = 48; idx < 52; idx++){
-		p_cmd_frame->field12 = (p_cmd_frame->field12 << 8) | (rx_buffer[idx]);
+	xTimeout = pdMS_TO_TICKS(p_frame->field4);
+	xInterval = pdMS_TO_TICKS(p_frame->field5);
+	if (xInterval == 0U)
+	{
+		xInterval = 1U;
 	}
 
-	/* -------  Extract field 13, bytes 52-55 ----- */
-	for (idx = 52; idx < 56; idx++){
-		p_cmd_frame->field13 = (p_cmd_frame->field13 << 8) | (rx_buffer[idx]);
+	/* The first read is immediate; between reads the command task sleeps, so
+	 * lower priority tasks run while the hardware gets ready. */
+	xStart = xTaskGetTickCount();
+	for (;;)
+	{
+		value = Xil_In32(p_frame->field1);
+		xElapsed = xTaskGetTickCount() - xStart;
+
+		if ( ((value & p_frame->field2) == p_frame->field3) == (p_frame->sz == CMD_POLL_EQUAL) )
+		{
+			status = CMD_POLL_MATCHED;
+			break;
+		}
+
+		if (xElapsed >= xTimeout)
+		{
+			status = CMD_POLL_TIMEOUT;
+			break;
+		}
+
+		vTaskDelay( (xTimeout - xElapsed < xInterval) ? (xTimeout - xElapsed) : xInterval );
 	}
 
+	setResponseBytes(&tx_data[0], status);
+	setResponseBytes(&tx_data[4], value);
+	setResponseBytes(&tx_data[8], (uint32_t)(xElapsed * portTICK_PERIOD_MS));
+	return 3U;
+}
+
+
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00DC: 32-bit reads from a list of addresses
+// sz = Number of addresses ; list format: see GATHER_READ in the header
+// Response: the words read, in list order
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdGatherRead(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const uint8_t *p_list;
+	uint32_t list_words;
+	uint32_t idx;
+
+	p_list = pListWords(p_frame, &list_words);
+
+	if ( (p_frame->sz > list_words) || (xCheckAddrList(p_list, p_frame->sz, 1U) != XST_SUCCESS) )
+	{
+		return CMD_HANDLER_ERROR;
+	}
 
-	/* -------  Extract field 14, bytes 56-59 ----- */
-	for (idx = 56; idx < 60; idx++){
-		p_cmd_frame->field14 = (p_cmd_frame->field14 << 8) | (rx_buffer[idx]);
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		setResponseBytes(tx_data, Xil_In32(ulCmdLoadBE32(p_list)));
+		p_list += 4;
+		tx_data += 4;
 	}
 
+	return p_frame->sz;
+}
+
 
+// --------------------------------------------------------------------------------- //
+// CMD = 0x00DD: 32-bit writes to a list of addresses
+// sz = Number of (address, data) pairs ; list format: see GATHER_READ in the header
+// --------------------------------------------------------------------------------- //
+static uint32_t cmdScatterWrite(const cmd_frame *p_frame, uint8_t *tx_data)
+{
+	const uint8_t *p_list;
+	uint32_t list_words;
+	uint32_t idx;
+
+	p_list = pListWords(p_frame, &list_words);
+
+	if ( (p_frame->sz > (list_words / 2U)) || (xCheckAddrList(p_list, p_frame->sz, 2U) != XST_SUCCESS) )
+	{
+		return CMD_HANDLER_ERROR;
+	}
 
-	/* -------  Extract field 15, bytes 60-63 ----- */
-	for (idx = 60; idx < 63; idx++){
-		p_cmd_frame->field15 = (p_cmd_frame->field15 << 8) | (rx_buffer[idx]);
+	for (idx = 0; idx < p_frame->sz; idx++)
+	{
+		Xil_Out32(ulCmdLoadBE32(&p_list[0]), ulCmdLoadBE32(&p_list[4]));
+		p_list += 8;
 	}
 
+	// Same response as WRITE_SEQUENTIAL
+	if (p_frame->is_long == 0U)
+	{
+		memcpy(tx_data, write_resp, 4U * p_frame->resp_words);
+		return p_frame->resp_words;
+	}
+
+	setResponseBytes(tx_data, WRITE_OKAY);
+	return 1U;
 }
 
 
 
 /******************************************************************************
 *
-* Function:		executeCommand()
+* Function:		pListWords
 *
-* Description:	Executes the received command and directly updates the comms
-* 				block transmit buffer with the response data.
+* Description:	Locates the list carried by a BATCH or scatter-gather frame.
 *
-* param[in]		*tx_buffer: Pointer to the transmit buffer in the comms block.
+* param[in]		*p_frame: Decoded frame.
+* param[out]	*p_list_words: Number of 32-bit words available for the list.
 *
-* Returns:		None.
+* Returns:		Pointer to the start of the list, in wire byte order.
 *
-* Notes:		None.
+* Notes:		In a 64-byte frame the list starts in place of field1; in a
+* 				long frame it is the data words.
 *
 ****************************************************************************/
 
+static const uint8_t *pListWords(const cmd_frame *p_frame, uint32_t *p_list_words)
+{
+	if (p_frame->is_long == 0U)
+	{
+		*p_list_words = p_frame->data_words + 1U;
+		return p_frame->p_data - 4U;
+	}
 
-void executeCommand(uint8_t *tx_buffer) {
-
-	/* Extract fields from the cmd_frame structure */
-	uint16_t cmd = p_cmd_frame->cmd;
-	uint16_t sz = p_cmd_frame->sz;
-
-	uint32_t field1 = p_cmd_frame->field1;
-	uint32_t field2 = p_cmd_frame->field2;
-	//
-	uint32_t field3 = p_cmd_frame->field3;
-	uint32_t field4 = p_cmd_frame->field4;
-	uint32_t field5 = p_cmd_frame->field5;
-	uint32_t field6 = p_cmd_frame->field6;
-	uint32_t field7 = p_cmd_frame->field7;
-	uint32_t field8 = p_cmd_frame->field8;
-	uint32_t field9 = p_cmd_frame->field9;
-	uint32_t field10 = p_cmd_frame->field10;
-	uint32_t field11 = p_cmd_frame->field11;
-	uint32_t field12 = p_cmd_frame->field12;
-	uint32_t field13 = p_cmd_frame->field13;
-	uint32_t field14 = p_cmd_frame->field14;
-	uint32_t field15 = p_cmd_frame->field15;
-
-	/* Variable to store memory read data */
-	uint32_t mem_read_data;
-
-	/* Array to store the write data values for sequential write command. */
-	uint32_t seq_wr_data_array[14] = {	field2, field3, field4, field5, field6,
-										field7, field8, field9, field10, field11,
-										field12, field13, field14, field15 };
-
-	// Generic loop variable
-	uint32_t idx;
+	*p_list_words = p_frame->data_words;
+	return p_frame->p_data;
+}
 
 
 
+/******************************************************************************
+*
+* Function:		xCheckAddrList
+*
+* Description:	Checks that every address in a scatter-gather list is 32-bit
+* 				aligned.
+*
+* param[in]		*p_list: List, in wire byte order.
+* param[in]		entries: Number of list entries.
+* param[in]		stride: Words per entry (the address is the first word).
+*
+* Returns:		XST_SUCCESS, or XST_FAILURE if an address is not aligned.
+*
+* Notes:		Called before the first access, so that a bad list has no
+* 				side effects.
+*
+****************************************************************************/
 
+static int xCheckAddrList(const uint8_t *p_list, uint32_t entries, uint32_t stride)
+{
+	uint32_t idx;
+	uint32_t addr_bits = 0U;
 
-	/* ----- Switch-Case to handle the packet ----- */
+	for (idx = 0; idx < entries; idx++)
+	{
+		addr_bits |= ulCmdLoadBE32(&p_list[4U * stride * idx]);
+	}
 
-	switch(cmd) {
+	return ((addr_bits & 0x3U) == 0U) ? XST_SUCCESS : XST_FAILURE;
+}
 
-	// --------------------------------------------------------------------------------- //
-	// WRITE_WORD: 32-bit write to memory location
-	// Field 1 = address ; Field 2 = Data
-	// --------------------------------------------------------------------------------- //
-	case WRITE_WORD:
-		/* Write the data and update the response buffer */
-		Xil_Out32(field1, field2);
-		setResponseBytes(tx_buffer, WRITE_OKAY);
-		break;
 
 
-	// --------------------------------------------------------------------------------- //
-	// CMD = 0x00D4: 32-bit read from memory location
-	// Field 1 = address
-	// --------------------------------------------------------------------------------- //
-	case READ_WORD:
-		/* Read the data and update the response buffer */
-		mem_read_data = Xil_In32(field1);
-		setResponseBytes(tx_buffer, mem_read_data);
-		break;
+/******************************************************************************
+*
+* Function:		setErrorResponse
+*
+* Description:	Updates the Tx Buffer with the error code: all 64 bytes for a
+* 				64-byte frame, a single word for a long frame.
+*
+* Returns:		Number of bytes to transmit.
+*
+* Notes:		None.
+*
+****************************************************************************/
 
+static uint32_t setErrorResponse(const cmd_frame *p_cmd_frame, uint8_t *tx_buffer)
+{
+	if (p_cmd_frame->is_long == 0U)
+	{
+		memcpy(tx_buffer, cmd_error_resp, CMD_FRAME_SIZE);
+		return (p_cmd_frame->has_crc == 0U) ? CMD_FRAME_SIZE : finishResponse(p_cmd_frame, tx_buffer, p_cmd_frame->resp_words);
+	}
 
+	setResponseBytes(&tx_buffer[CMD_LONG_HDR_SIZE], CMD_ERROR);
+	return finishResponse(p_cmd_frame, tx_buffer, 1U);
+}
 
-	// --------------------------------------------------------------------------------- //
-	// CMD = 0x00D5: 32-bit write to memory locations
-	// Field 1 = Start Address ; Field 16 = Number of locations to write
-	// --------------------------------------------------------------------------------- //
-	case WRITE_SEQUENTIAL:
-		// Write the data
-		for (idx = 0; idx < sz; idx++)
-		{
-			Xil_Out32(field1, seq_wr_data_array[idx]);
-			field1 += 4;
-		}
-		// Update the response buffer with response code (all 64 bytes)
-		for (idx = 0; idx < 16; idx++)
-		{
-			setResponseBytes(tx_buffer,  write_resp[idx]);
-			tx_buffer += 4;
-		}
 
-		break;
 
-	// --------------------------------------------------------------------------------- //
-	// CMD = 0x00D6: 32-bit read from memory locations
-	// Field 1 = Start Address ; Field 16 = Number of locations to read
-	// --------------------------------------------------------------------------------- //
-	case READ_SEQUENTIAL:
-		for (idx = 0; idx < sz; idx++)
-		{
-			mem_read_data = Xil_In32(field1);
-			setResponseBytes(tx_buffer,  mem_read_data);
-			field1 += 4;
-			tx_buffer += 4;
-		}
-		break;
+/******************************************************************************
+*
+* Function:		setCrcErrorResponse
+*
+* Description:	Updates the Tx Buffer with the CRC error response: a 64-byte
+* 				frame of CMD_CRC_ERROR words with a CRC trailer.
+*
+* Returns:		Number of bytes to transmit.
+*
+* Notes:		The response is always a 64-byte frame, because the header of
+* 				the received frame cannot be trusted.
+*
+****************************************************************************/
 
+static uint32_t setCrcErrorResponse(uint8_t *tx_buffer)
+{
+	uint32_t idx;
 
-	// --------------------------------------------------------------------------------- //
-	// Handle unknown commands
-	// --------------------------------------------------------------------------------- //
-	default:
-		/* Update the response buffer with error code (all 64 bytes) */
-		for (idx = 0; idx < 16; idx++)
-		{
-			setResponseBytes(tx_buffer,  cmd_error_resp[idx]);
-			tx_buffer += 4;
-		}
-		// setResponseBytes(tx_buffer, CMD_ERROR);
-		break;
+	for (idx = 0; idx < (CMD_FRAME_SIZE - CMD_CRC_SIZE); idx += 4U)
+	{
+		setResponseBytes(&tx_buffer[idx], CMD_CRC_ERROR);
 	}
 
+	setResponseBytes(&tx_buffer[idx], ulCrc32(tx_buffer, idx));
+	return CMD_FRAME_SIZE;
 }
 
 
 
+/******************************************************************************
+*
+* Function:		ulCmdHandlerCtxCrcErrors
+*
+* Description:	Returns the number of frames the instance rejected because of
+* 				a bad CRC.
+*
+* Returns:		CRC error count.
+*
+* Notes:		None.
+*
+****************************************************************************/
+
+uint32_t ulCmdHandlerCtxCrcErrors(const CmdHandlerCtx_s *p_ctx)
+{
+	return p_ctx->ulCrcErrorCount;
+}
+
+
 
 /******************************************************************************
 *
 * Function:		setResponseBytes
 *
 * Description:	Updates the 4-byte Tx Buffer of the communications block with
-* 				the data to be transmitted back to the host.
+* 				the data to be transmitted back to the host (byte-reverse and
+* 				a single word store).
 *
 * Returns:		None.
 *
@@ -372,10 +1148,7 @@ void executeCommand(uint8_t *tx_buffer) {
 
 void setResponseBytes(uint8_t* tx_buffer, uint32_t tx_data)
 {
-	*tx_buffer = (tx_data >> 24) & 0xFF;
-	*(tx_buffer + 1) = (tx_data >> 16) & 0xFF;
-	*(tx_buffer + 2) = (tx_data >> 8) & 0xFF;
-	*(tx_buffer + 3) = tx_data & 0xFF;
+	vCmdStoreBE32(tx_buffer, tx_data);
 }
 
 
@@ -39,6 +39,7 @@
 /* Xilinx files */
 #include "xil_types.h"
 #include "xil_io.h"
+#include "xstatus.h"
 
 
 /*****************************************************************************/
@@ -48,7 +49,126 @@
 
 #define WRITE_OKAY			(0x01010101U)
 #define CMD_ERROR			(0xEEAA5577U)
-
+#define CMD_CRC_ERROR		(0xEEAACCCCU)
+
+
+/* Frame layout: 16 big-endian 32-bit words. Word 0 holds cmd/sz, words 1-15
+ * hold field1-field15. */
+#define CMD_FRAME_SIZE			64U
+#define CMD_FRAME_WORDS			(CMD_FRAME_SIZE / 4U)
+#define CMD_FRAME_FIELDS		(CMD_FRAME_WORDS - 1U)
+
+
+/* Long frames. Bit 15 of the command marks a long frame, which is only
+ * accepted after the host has negotiated its size with NEGOTIATE_FRAME.
+ * The long frame header is followed by up to CMD_LONG_FRAME_MAX_WORDS data words:
+ *   Bytes 0-1:		cmd | CMD_LONG_FRAME
+ *   Bytes 2-3:		sz
+ *   Bytes 4-7:		field1 (start addr in memory operations)
+ *   Bytes 8-11:	frame length in bytes (header + data words)
+ *   Bytes 12-...:	data words
+ * Responses to long frames use the same header. On the wire, long frames are
+ * padded with zeros to a multiple of CMD_FRAME_SIZE, because the UART receive
+ * path works in 64-byte blocks. */
+#define CMD_LONG_FRAME				0x8000U
+#define CMD_LONG_HDR_SIZE			12U
+#define CMD_LONG_FRAME_MAX_SIZE		4096U
+#define CMD_LONG_FRAME_MAX_WORDS	((CMD_LONG_FRAME_MAX_SIZE - CMD_LONG_HDR_SIZE) / 4U)
+
+/* CRC trailer. Bit 14 of the command asks for a CRC32 (see crc32.h) on the
+ * frame and on its response, stored big-endian:
+ *   64-byte frame:	bytes 60-63 hold the CRC of bytes 0-59, so field15 is not
+ *					available (WRITE_SEQUENTIAL carries up to 13 words).
+ *   Long frame:	the CRC of the 'frame length' bytes follows them; the frame
+ *					length does not include the CRC.
+ * The CRC is checked before the command is decoded further or executed. A
+ * frame that fails the check is answered with a 64-byte frame of
+ * CMD_CRC_ERROR words with its own CRC trailer. */
+#define CMD_CRC_FRAME				0x4000U
+#define CMD_CRC_SIZE				4U
+
+/* Number of bytes a frame of 'len' bytes occupies on the wire. */
+#define CMD_FRAME_WIRE_SIZE(len)	( ((len) + (CMD_FRAME_SIZE - 1U)) & ~(CMD_FRAME_SIZE - 1U) )
+
+
+/* Command table. Commands are looked up directly using the low byte of the
+ * opcode, so two commands whose opcodes share a low byte cannot both be
+ * registered. Opcode ranges:
+ * 0x00D0 - 0x00DF: Commands built into the command handler.
+ * 0x00E0 - 0x00EF: Application-specific commands (see xCmdHandlerRegister). */
+#define CMD_TABLE_SIZE			256U
+#define CMD_TABLE_INDEX(cmd)	((cmd) & (CMD_TABLE_SIZE - 1U))
+
+/* Command validation flags */
+#define CMD_FLAG_NONE			(0x00U)
+#define CMD_FLAG_ADDR_ALIGNED	(0x01U)	// field1 must be 32-bit aligned
+#define CMD_FLAG_SZ_DATA		(0x02U)	// sz must not exceed the data words received
+#define CMD_FLAG_SZ_RESP		(0x04U)	// sz must not exceed the response data words
+#define CMD_FLAG_BATCHABLE		(0x08U)	// may be used as a BATCH sub-command
+
+/* Return value for command execution functions that reject the frame: the
+ * command handler sends the CMD_ERROR response instead. */
+#define CMD_HANDLER_ERROR		(0xFFFFFFFFU)
+
+
+/* BATCH frames. sz = number of sub-command records, executed in order. Each
+ * record is 10 bytes:
+ *   Byte 0:		sequence ID (echoed in the response)
+ *   Byte 1:		sub-command (low byte of a CMD_FLAG_BATCHABLE opcode)
+ *   Bytes 2-5:		field1 (address)
+ *   Bytes 6-9:		field2 (data)
+ * In a 64-byte frame the records start at byte 4 (in place of field1), so six
+ * fit (five with a CRC trailer); in a long frame they follow the header. The response holds one 8-byte
+ * record per sub-command:
+ *   Byte 0:		sequence ID
+ *   Byte 1:		CMD_BATCH_xxx status
+ *   Byte 2:		sub-command
+ *   Byte 3:		0
+ *   Bytes 4-7:		response word of the sub-command (e.g. READ_WORD data)
+ * Execution stops at the first sub-command that fails; the records after it
+ * are returned with CMD_BATCH_SKIPPED. */
+#define CMD_BATCH_REQ_SIZE			10U
+#define CMD_BATCH_RESP_SIZE			8U
+
+#define CMD_BATCH_OK				0x00U
+#define CMD_BATCH_BAD_CMD			0x01U	// Unknown, or not CMD_FLAG_BATCHABLE
+#define CMD_BATCH_BAD_ARGS			0x02U	// Failed the table entry checks
+#define CMD_BATCH_SKIPPED			0x03U	// Not executed (earlier failure)
+
+
+/* Register access commands, executed on the target so that the host does not
+ * need a round trip per step:
+ *   READ_MODIFY_WRITE:	new = (old & field2) ^ field3
+ *   MASKED_WRITE:		new = (old & ~field2) | (field3 & field2)
+ * Both read, modify and write the word inside a critical section and respond
+ * with word 0 = old value, word 1 = value read back after the write.
+ *   POLL_UNTIL:		reads field1 until (value & field2) == field3 (sz = 0)
+ *						or != field3 (sz = 1). field4 = timeout in ms (at most
+ *						CMD_POLL_MAX_TIMEOUT_MS), field5 = interval between
+ *						reads in ms (at least one tick). The command task
+ *						sleeps between reads. Response: word 0 = CMD_POLL_xxx
+ *						status, word 1 = last value read, word 2 = time taken
+ *						in ms. A timeout is a normal response, not CMD_ERROR. */
+#define CMD_POLL_MAX_TIMEOUT_MS		10000U
+
+#define CMD_POLL_EQUAL				0x0000U		// sz: wait until equal
+#define CMD_POLL_NOT_EQUAL			0x0001U		// sz: wait until not equal
+
+#define CMD_POLL_MATCHED			0x00000000U
+#define CMD_POLL_TIMEOUT			0x00000001U
+
+
+/* Scatter-gather commands. The address list (and, for SCATTER_WRITE, the
+ * data) replaces field1 onwards in a 64-byte frame and follows the header in
+ * a long frame, like BATCH records:
+ *   GATHER_READ:		sz addresses; the response holds the sz words read,
+ *						in list order. Up to 15 addresses in a 64-byte frame
+ *						(14 with a CRC), 16 response words.
+ *   SCATTER_WRITE:		sz (address, data) pairs, written in list order. Up
+ *						to 7 pairs in a 64-byte frame. Same response as
+ *						WRITE_SEQUENTIAL.
+ * Every address must be 32-bit aligned; the whole list is checked before
+ * the first access, so a rejected frame has no side effects. */
 
 
 
@@ -58,41 +178,103 @@
 /*****************************************************************************/
 
 
+struct CmdHandlerCtx_s;
+
 typedef struct {
 	uint16_t cmd;		// Bytes 0-1
 	uint16_t sz;		// Bytes 2-3
 
-	uint32_t field1; 	// Bytes 4-7		start addr in memory operations
-
-	uint32_t field2;	// Bytes 8-11		data 1
-	uint32_t field3;	// Bytes 12-15		data 2
-	uint32_t field4;	// Bytes 16-19		data 3
-	uint32_t field5;	// Bytes 20-23		data 4
-	uint32_t field6;	// Bytes 24-27		data 5
-	uint32_t field7;	// Bytes 28-31		data 6
-	uint32_t field8;	// Bytes 32-35		data 7
-	uint32_t field9;	// Bytes 36-39		data 8
-	uint32_t field10;	// Bytes 40-43		data 9
-	uint32_t field11;	// Bytes 44-47		data 10
-	uint32_t field12;	// Bytes 48-51		data 11
-	uint32_t field13;	// Bytes 52-55		data 12
-	uint32_t field14;	// Bytes 56-59		data 13
-	uint32_t field15;	// Bytes 60-63		data 14
+	/* The fields can be accessed by name or, for the codec and the sequential
+	 * commands, as an array: fields[0] = field1 ... fields[14] = field15. */
+	union {
+		struct {
+			uint32_t field1; 	// Bytes 4-7		start addr in memory operations
+
+			uint32_t field2;	// Bytes 8-11		data 1
+			uint32_t field3;	// Bytes 12-15		data 2
+			uint32_t field4;	// Bytes 16-19		data 3
+			uint32_t field5;	// Bytes 20-23		data 4
+			uint32_t field6;	// Bytes 24-27		data 5
+			uint32_t field7;	// Bytes 28-31		data 6
+			uint32_t field8;	// Bytes 32-35		data 7
+			uint32_t field9;	// Bytes 36-39		data 8
+			uint32_t field10;	// Bytes 40-43		data 9
+			uint32_t field11;	// Bytes 44-47		data 10
+			uint32_t field12;	// Bytes 48-51		data 11
+			uint32_t field13;	// Bytes 52-55		data 12
+			uint32_t field14;	// Bytes 56-59		data 13
+			uint32_t field15;	// Bytes 60-63		data 14
+		};
+		uint32_t fields[CMD_FRAME_FIELDS];
+	};
+
+	/* Frame format and data view. The data words are field2-field15 in a
+	 * 64-byte frame and follow the header in a long frame. In both formats
+	 * field2 onwards hold the first (up to 14) data words. */
+	uint8_t			is_long;		// 1 => long frame
+	uint8_t			has_crc;		// 1 => CRC trailer on the frame and the response
+	uint32_t		frame_len;		// Bytes covered by the CRC (excludes padding)
+	const uint8_t	*p_data;		// Data words, in wire (big-endian) order
+	uint32_t		data_words;		// Number of data words at p_data
+	uint32_t		resp_words;		// Response data words the handler may write
+
+	/* Handler instance (channel) the frame was received on. */
+	struct CmdHandlerCtx_s	*p_ctx;
 } cmd_frame;
 
 
 
+/* -------- Handler instance -------- */
+
+/* All per-channel state of the command handler. Each command task owns one
+ * instance and passes it to ulCmdHandlerProcess(), so several tasks can handle
+ * commands at the same time. The command table and the CRC tables are shared
+ * (read-only once initialised). */
+typedef struct CmdHandlerCtx_s {
+	cmd_frame		Frame;				// Frame being handled
+	uint32_t		ulLongFrameMax;		// Agreed by NEGOTIATE_FRAME; 0 => legacy only
+	uint32_t		ulCrcErrorCount;	// Frames rejected because of a bad CRC
+} CmdHandlerCtx_s;
+
+
+
 /* -------- Commands -------- */
 typedef enum
 {
 	WRITE_WORD = 0x00D3,
 	READ_WORD = 0x00D4,
 	WRITE_SEQUENTIAL = 0x00D5,
-	READ_SEQUENTIAL = 0x00D6
+	READ_SEQUENTIAL = 0x00D6,
+	NEGOTIATE_FRAME = 0x00D7,
+	BATCH = 0x00D8,
+	READ_MODIFY_WRITE = 0x00D9,
+	MASKED_WRITE = 0x00DA,
+	POLL_UNTIL = 0x00DB,
+	GATHER_READ = 0x00DC,
+	SCATTER_WRITE = 0x00DD
 }commands;
 
 
 
+/* -------- Command table -------- */
+
+/* Command execution function. Called with the decoded frame (already validated
+ * against the table entry), it writes up to p_cmd_frame->resp_words response
+ * data words to tx_data and returns the number of words written, or
+ * CMD_HANDLER_ERROR. CMD_FLAG_BATCHABLE commands take their arguments from
+ * field1/field2 only and write at most one response word. */
+typedef uint32_t (*CmdHandlerFn_t)(const cmd_frame *p_cmd_frame, uint8_t *tx_data);
+
+typedef struct {
+	uint16_t		cmd;		// Full opcode; guards against low-byte aliasing
+	uint16_t		min_sz;		// Smallest 'sz' value accepted
+	uint16_t		max_sz;		// Largest 'sz' value accepted
+	uint8_t			flags;		// CMD_FLAG_xxx validation flags
+	CmdHandlerFn_t	fp_handler;	// NULL => table slot is unused
+} CmdTableEntry_s;
+
+
+
 /*****************************************************************************/
 /************************** Variable Declarations ****************************/
 /*****************************************************************************/
@@ -102,13 +284,67 @@ typedef enum
 /***************** Macros (Inline Functions) Definitions ********************/
 /****************************************************************************/
 
+/* Frame words are big-endian on the wire; the Cortex-A9 runs little-endian.
+ * CMD_BSWAP32 is for constant initialisers, the inline functions below are
+ * for run-time use (single REV instruction + unaligned-safe load/store). */
+#define CMD_BSWAP32(x)		( (((x) & 0x000000FFU) << 24) | (((x) & 0x0000FF00U) << 8) | \
+							  (((x) & 0x00FF0000U) >> 8)  | (((x) & 0xFF000000U) >> 24) )
+
+static inline uint32_t ulCmdLoadBE32(const uint8_t *p_src)
+{
+	uint32_t word;
+	__builtin_memcpy(&word, p_src, sizeof(word));
+	return __builtin_bswap32(word);
+}
+
+static inline void vCmdStoreBE32(uint8_t *p_dst, uint32_t word)
+{
+	word = __builtin_bswap32(word);
+	__builtin_memcpy(p_dst, &word, sizeof(word));
+}
+
 
 /*****************************************************************************/
 /************************** Function Prototypes ******************************/
 /*****************************************************************************/
 
-/* Main function to be used by e.g. comms block ISR, FreeRTOS task, etc. */
+/* Initialises the shared parts of the command handler (CRC tables). Call
+ * once at start-up. */
+void vCmdHandlerInit(void);
+
+/* Initialises a handler instance (one per channel). */
+void vCmdHandlerCtxInit(CmdHandlerCtx_s *p_ctx);
+
+/* Handles a 64-byte or long frame on the given instance. Returns the number of
+ * bytes to transmit from tx_buffer (a multiple of CMD_FRAME_SIZE). */
+uint32_t ulCmdHandlerProcess(CmdHandlerCtx_s *p_ctx,
+								uint8_t *rx_buffer, uint32_t rx_len,
+								uint8_t *tx_buffer, uint32_t tx_max);
+
+/* Given the first 64-byte block of a frame, returns the number of bytes the
+ * receive path must collect for the whole frame. */
+uint32_t ulCmdHandlerFrameWireSize(const CmdHandlerCtx_s *p_ctx, const uint8_t *rx_block);
+
+/* Number of frames rejected by the instance because of a bad CRC. */
+uint32_t ulCmdHandlerCtxCrcErrors(const CmdHandlerCtx_s *p_ctx);
+
+
+/* Single-channel interface, kept for existing callers. These use a default
+ * instance inside the command handler, so only one task may call them. */
 void handleCommand64B(uint8_t *rx_buffer, uint8_t *tx_buffer);
+uint32_t ulHandleCommandFrame(uint8_t *rx_buffer, uint32_t rx_len,
+								uint8_t *tx_buffer, uint32_t tx_max);
+uint32_t ulCmdFrameWireSize(const uint8_t *rx_block);
+uint32_t ulCmdHandlerCrcErrors(void);
+
+/* Add an application command to the command table. Must be called before
+ * the scheduler is started (the table is not protected against concurrent
+ * access). */
+int xCmdHandlerRegister(uint16_t cmd, uint16_t min_sz, uint16_t max_sz,
+						uint8_t flags, CmdHandlerFn_t fp_handler);
+
+/* Helper for command execution functions: writes a 32-bit response word. */
+void setResponseBytes(uint8_t *tx_buffer, uint32_t tx_data);
 
 
 #endif /* SRC_CMD_HANDLER_H_ */
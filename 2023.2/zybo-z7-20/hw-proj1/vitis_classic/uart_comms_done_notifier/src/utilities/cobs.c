@@ -0,0 +1,202 @@
+/******************************************************************************
+ * @Title		:	COBS Framing
+ * @Filename	:	cobs.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "cobs.h"
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		ulCobsEncode()
+*
+* Description:	Encodes a frame and appends the delimiter.
+*
+* param[in]		*p_src: Frame to encode.
+* param[in]		len: Number of bytes in the frame.
+* param[out]	*p_dst: Encoded frame.
+*
+* Returns:		Number of bytes written to p_dst, delimiter included.
+*
+* Notes:		Each source byte is read before its encoded copy (at most
+* 				COBS_MAX_OVERHEAD(len) - 1 bytes further on) is written, and
+* 				the code bytes are written behind the copy, so the frame can
+* 				be encoded in place if it is preceded by that much headroom.
+*
+****************************************************************************/
+
+uint32_t ulCobsEncode(const uint8_t *p_src, uint32_t len, uint8_t *p_dst)
+{
+	uint32_t code_idx = 0U;		// Where the current block's code byte goes
+	uint32_t out = 1U;
+	uint8_t code = 1U;
+	uint8_t byte;
+	uint32_t idx;
+
+	for (idx = 0U; idx < len; idx++)
+	{
+		byte = p_src[idx];
+
+		if (byte == COBS_DELIMITER)
+		{
+			p_dst[code_idx] = code;
+			code_idx = out++;
+			code = 1U;
+		}
+		else
+		{
+			p_dst[out++] = byte;
+			code++;
+
+			if (code == 0xFFU)
+			{
+				p_dst[code_idx] = code;
+				code_idx = out++;
+				code = 1U;
+			}
+		}
+	}
+
+	p_dst[code_idx] = code;
+	p_dst[out++] = COBS_DELIMITER;
+
+	return out;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vCobsDecoderReset()
+*
+* Description:	Starts a new frame.
+*
+* param[in]		*p_dec: Decoder.
+* param[in]		*p_dst: Buffer for the decoded frame.
+* param[in]		max: Size of the buffer.
+*
+* Returns:		None.
+*
+****************************************************************************/
+
+void vCobsDecoderReset(CobsDecoder_s *p_dec, uint8_t *p_dst, uint32_t max)
+{
+	p_dec->pucDst = p_dst;
+	p_dec->ulMax = max;
+	p_dec->ulLength = 0U;
+	p_dec->ucCode = 0U;
+	p_dec->ucLeft = 0U;
+	p_dec->ucOverflow = 0U;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulCobsDecode()
+*
+* Description:	Decodes bytes of the encoded stream into the current frame,
+* 				stopping after the first delimiter.
+*
+* param[in]		*p_dec: Decoder.
+* param[in]		*p_src: Encoded bytes.
+* param[in]		len: Number of encoded bytes.
+* param[out]	*p_status: COBS_IN_PROGRESS if all bytes were used without
+* 				finding a delimiter, otherwise COBS_FRAME_DONE (p_dec->ulLength
+* 				bytes decoded; 0 for back-to-back delimiters) or
+* 				COBS_FRAME_BAD.
+*
+* Returns:		Number of bytes used from p_src (delimiter included).
+*
+* Notes:		A frame is bad if it ends in the middle of a block (a byte was
+* 				lost, or a delimiter was injected) or does not fit in the
+* 				buffer. Either way the decoder has skipped to the delimiter, so
+* 				the next frame is decoded normally.
+*
+****************************************************************************/
+
+uint32_t ulCobsDecode(CobsDecoder_s *p_dec, const uint8_t *p_src, uint32_t len, uint32_t *p_status)
+{
+	uint32_t idx;
+	uint8_t byte;
+
+	for (idx = 0U; idx < len; idx++)
+	{
+		byte = p_src[idx];
+
+		if (byte == COBS_DELIMITER)
+		{
+			*p_status = ( (p_dec->ucLeft != 0U) || (p_dec->ucOverflow != 0U) ) ? COBS_FRAME_BAD : COBS_FRAME_DONE;
+			return idx + 1U;
+		}
+
+		if (p_dec->ucLeft == 0U)
+		{
+			/* Code byte. A block shorter than the maximum was followed by a
+			 * 0x00 in the frame. */
+			if ( (p_dec->ucCode != 0U) && (p_dec->ucCode != 0xFFU) )
+			{
+				if (p_dec->ulLength < p_dec->ulMax)		{ p_dec->pucDst[p_dec->ulLength++] = 0x00U; }
+				else									{ p_dec->ucOverflow = 1U; }
+			}
+
+			p_dec->ucCode = byte;
+			p_dec->ucLeft = byte - 1U;
+		}
+		else
+		{
+			if (p_dec->ulLength < p_dec->ulMax)		{ p_dec->pucDst[p_dec->ulLength++] = byte; }
+			else									{ p_dec->ucOverflow = 1U; }
+
+			p_dec->ucLeft--;
+		}
+	}
+
+	*p_status = COBS_IN_PROGRESS;
+	return len;
+}
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
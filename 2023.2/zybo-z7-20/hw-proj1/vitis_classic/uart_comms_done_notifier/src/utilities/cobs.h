@@ -0,0 +1,101 @@
+/******************************************************************************
+ * @Title		:	COBS Framing (Header File)
+ * @Filename	:	cobs.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+#ifndef SRC_UTILITIES_COBS_H_
+#define SRC_UTILITIES_COBS_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* Consistent Overhead Byte Stuffing. The encoder removes every 0x00 from the
+ * frame, so 0x00 only ever appears as the frame delimiter: a receiver that
+ * loses or gains a byte drops (at most) the frame it is in, and is back in
+ * step at the next delimiter. Each block is a code byte N (1-255) followed by
+ * N-1 data bytes; N < 255 means a 0x00 follows the block (except at the end
+ * of the frame). */
+#define COBS_DELIMITER			(0x00U)
+
+/* Bytes added by ulCobsEncode() to a frame of 'len' bytes, delimiter included. */
+#define COBS_MAX_OVERHEAD(len)	(2U + ((len) / 254U))
+
+/* Decoder status */
+#define COBS_IN_PROGRESS		(0U)	// No delimiter yet
+#define COBS_FRAME_DONE			(1U)	// Delimiter: ulLength bytes decoded
+#define COBS_FRAME_BAD			(2U)	// Delimiter: frame truncated or too long
+
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+/* Decoder state. The encoded stream can arrive in pieces of any size (e.g.
+ * straight from a receive ring); the decoder picks up where it left off. */
+typedef struct {
+	uint8_t		*pucDst;		// Decoded frame
+	uint32_t	ulMax;			// Size of pucDst
+	uint32_t	ulLength;		// Bytes decoded so far
+	uint8_t		ucCode;			// Code byte of the current block (0 = none yet)
+	uint8_t		ucLeft;			// Data bytes still to come in the current block
+	uint8_t		ucOverflow;		// 1 => frame longer than ulMax, skipped to the delimiter
+} CobsDecoder_s;
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Encodes 'len' bytes and appends the delimiter. Returns the number of bytes
+ * written to p_dst (at most len + COBS_MAX_OVERHEAD(len)). The frame may be
+ * encoded in place: p_dst may overlap p_src as long as p_dst is at least
+ * COBS_MAX_OVERHEAD(len) bytes before p_src. */
+uint32_t ulCobsEncode(const uint8_t *p_src, uint32_t len, uint8_t *p_dst);
+
+/* Starts a new frame in the given buffer. */
+void vCobsDecoderReset(CobsDecoder_s *p_dec, uint8_t *p_dst, uint32_t max);
+
+/* Decodes bytes up to and including the next delimiter. Returns the number of
+ * bytes used from p_src and sets *p_status. After COBS_FRAME_DONE or
+ * COBS_FRAME_BAD, call vCobsDecoderReset() before the next frame. */
+uint32_t ulCobsDecode(CobsDecoder_s *p_dec, const uint8_t *p_src, uint32_t len, uint32_t *p_status);
+
+
+#endif /* SRC_UTILITIES_COBS_H_ */
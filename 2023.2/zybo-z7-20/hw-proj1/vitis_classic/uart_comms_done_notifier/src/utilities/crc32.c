@@ -0,0 +1,185 @@
+/******************************************************************************
+ * @Title		:	CRC32
+ * @Filename	:	crc32.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "crc32.h"
+
+
+
+
+/*****************************************************************************/
+/************************** Variable Declarations ****************************/
+/*****************************************************************************/
+
+/* Crc32Table[0] is the classic byte-wise table. Crc32Table[k][i] is the CRC of
+ * byte i followed by k zero bytes, so eight bytes can be folded in at once. */
+static uint32_t Crc32Table[CRC32_SLICES][256];
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		vCrc32Init()
+*
+* Description:	Builds the slicing-by-8 lookup tables.
+*
+* Returns:		None.
+*
+* Notes:		The tables are built at run-time (about 2k table entries of
+* 				simple shifts) rather than stored as 8 KB of constants.
+*
+****************************************************************************/
+
+void vCrc32Init(void)
+{
+	uint32_t idx;
+	uint32_t bit;
+	uint32_t slice;
+	uint32_t crc;
+
+	for (idx = 0; idx < 256U; idx++)
+	{
+		crc = idx;
+		for (bit = 0; bit < 8U; bit++)
+		{
+			crc = (crc & 1U) ? ((crc >> 1) ^ CRC32_POLY_REFLECTED) : (crc >> 1);
+		}
+		Crc32Table[0][idx] = crc;
+	}
+
+	for (idx = 0; idx < 256U; idx++)
+	{
+		crc = Crc32Table[0][idx];
+		for (slice = 1; slice < CRC32_SLICES; slice++)
+		{
+			crc = (crc >> 8) ^ Crc32Table[0][crc & 0xFFU];
+			Crc32Table[slice][idx] = crc;
+		}
+	}
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulCrc32()
+*
+* Description:	Calculates the CRC32 of a buffer.
+*
+* Returns:		CRC32 value.
+*
+* Notes:		None.
+*
+****************************************************************************/
+
+uint32_t ulCrc32(const uint8_t *p_data, uint32_t len)
+{
+	return ulCrc32Update(0U, p_data, len);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulCrc32Update()
+*
+* Description:	Continues a CRC32 calculation over another buffer.
+*
+* Returns:		CRC32 value.
+*
+* Notes:		Bytes are processed one at a time up to a word boundary, then
+* 				eight at a time (two aligned word loads, eight table lookups),
+* 				then one at a time for the tail. The word loads assume a
+* 				little-endian CPU, which the Cortex-A9 is configured as.
+*
+****************************************************************************/
+
+uint32_t ulCrc32Update(uint32_t crc, const uint8_t *p_data, uint32_t len)
+{
+	uint32_t one;
+	uint32_t two;
+
+	crc = ~crc;
+
+	/* Head: up to a word boundary */
+	while ( (len > 0U) && (((UINTPTR)p_data & 0x3U) != 0U) )
+	{
+		crc = Crc32Table[0][(crc ^ *p_data++) & 0xFFU] ^ (crc >> 8);
+		len--;
+	}
+
+	/* Body: eight bytes per iteration */
+	while (len >= 8U)
+	{
+		memcpy(&one, p_data, sizeof(one));
+		memcpy(&two, p_data + 4, sizeof(two));
+		one ^= crc;
+
+		crc = Crc32Table[7][one & 0xFFU] ^
+			  Crc32Table[6][(one >> 8) & 0xFFU] ^
+			  Crc32Table[5][(one >> 16) & 0xFFU] ^
+			  Crc32Table[4][one >> 24] ^
+			  Crc32Table[3][two & 0xFFU] ^
+			  Crc32Table[2][(two >> 8) & 0xFFU] ^
+			  Crc32Table[1][(two >> 16) & 0xFFU] ^
+			  Crc32Table[0][two >> 24];
+
+		p_data += 8;
+		len -= 8U;
+	}
+
+	/* Tail */
+	while (len > 0U)
+	{
+		crc = Crc32Table[0][(crc ^ *p_data++) & 0xFFU] ^ (crc >> 8);
+		len--;
+	}
+
+	return ~crc;
+}
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
@@ -0,0 +1,70 @@
+/******************************************************************************
+ * @Title		:	CRC32 (Header File)
+ * @Filename	:	crc32.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+#ifndef SRC_UTILITIES_CRC32_H_
+#define SRC_UTILITIES_CRC32_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* CRC-32 as used by Ethernet/zlib: reflected polynomial 0x04C11DB7, initial
+ * value and final XOR 0xFFFFFFFF. Check value: CRC32("123456789") = 0xCBF43926. */
+#define CRC32_POLY_REFLECTED		(0xEDB88320U)
+
+/* Slicing-by-8: eight 256-entry tables (8 KB), eight bytes per iteration. */
+#define CRC32_SLICES				8U
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Builds the lookup tables. Call once before the first CRC is calculated. */
+void vCrc32Init(void);
+
+/* CRC of a buffer. */
+uint32_t ulCrc32(const uint8_t *p_data, uint32_t len);
+
+/* Continues a CRC over another buffer: ulCrc32Update(ulCrc32(a), b) is the
+ * CRC of a followed by b. Start with crc = 0. */
+uint32_t ulCrc32Update(uint32_t crc, const uint8_t *p_data, uint32_t len);
+
+
+#endif /* SRC_UTILITIES_CRC32_H_ */
@@ -0,0 +1,208 @@
+/******************************************************************************
+ * @Title		:	Deferred Binary Log
+ * @Filename	:	dlog.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "dlog.h"
+
+
+
+/*****************************************************************************/
+/************************** Variable Definitions *****************************/
+/*****************************************************************************/
+
+/* Each slot's ulSeq says what the slot holds, for the record number 'pos'
+ * that maps onto it:
+ *   ulSeq == pos			free: a producer may claim record 'pos'
+ *   ulSeq == pos + 1		record 'pos' written: the consumer may read it
+ *   ulSeq == pos + SIZE	read: free for record 'pos + SIZE'
+ * Producers claim a record number with a compare-and-swap on ulDlogHead, fill
+ * the slot, then publish it through ulSeq. A producer interrupted between the
+ * two (e.g. by an ISR that logs) only delays the consumer, which reads the
+ * records in order. */
+static DlogRecord_s xDlogRecords[DLOG_RECORD_COUNT];
+static volatile uint32_t ulDlogHead;		// Records claimed (producers)
+static uint32_t ulDlogTail;					// Records read (consumer)
+static volatile uint32_t ulDlogDropped;
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		vDlogInit()
+*
+* Description:	Empties the log.
+*
+****************************************************************************/
+
+void vDlogInit(void)
+{
+	uint32_t idx;
+
+	for (idx = 0U; idx < DLOG_RECORD_COUNT; idx++)
+	{
+		xDlogRecords[idx].ulSeq = idx;
+	}
+
+	ulDlogTail = 0U;
+	ulDlogDropped = 0U;
+	__atomic_store_n(&ulDlogHead, 0U, __ATOMIC_RELEASE);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vDlogWrite()
+*
+* Description:	Writes a record to the log, or counts it as dropped if the log
+* 				is full.
+*
+* param[in]		id: Message ID (index into the format string table).
+* param[in]		arg_count: Number of arguments used (at most DLOG_MAX_ARGS).
+* param[in]		a0 - a3: Arguments.
+*
+* Notes:		Safe in tasks and ISRs. Costs a timer read, an exclusive
+* 				load/store pair and one cache line of stores.
+*
+****************************************************************************/
+
+void vDlogWrite(uint16_t id, uint32_t arg_count, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+	DlogRecord_s *p_rec;
+	XTime time;
+	uint32_t pos;
+	int32_t diff;
+
+	XTime_GetTime(&time);
+
+	pos = __atomic_load_n(&ulDlogHead, __ATOMIC_RELAXED);
+	for (;;)
+	{
+		p_rec = &xDlogRecords[pos & (DLOG_RECORD_COUNT - 1U)];
+		diff = (int32_t)(__atomic_load_n(&p_rec->ulSeq, __ATOMIC_ACQUIRE) - pos);
+
+		if (diff == 0)
+		{
+			/* Slot free: claim it (pos is reloaded if another producer got there first). */
+			if (__atomic_compare_exchange_n(&ulDlogHead, &pos, pos + 1U, 1,
+											__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			/* Slot still holds a record that has not been read: log full. */
+			__atomic_fetch_add(&ulDlogDropped, 1U, __ATOMIC_RELAXED);
+			return;
+		}
+		else
+		{
+			pos = __atomic_load_n(&ulDlogHead, __ATOMIC_RELAXED);
+		}
+	}
+
+	p_rec->usId = id;
+	p_rec->usArgCount = (uint16_t)arg_count;
+	p_rec->xTime = time;
+	p_rec->ulArg[0] = a0;
+	p_rec->ulArg[1] = a1;
+	p_rec->ulArg[2] = a2;
+	p_rec->ulArg[3] = a3;
+
+	__atomic_store_n(&p_rec->ulSeq, pos + 1U, __ATOMIC_RELEASE);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulDlogRead()
+*
+* Description:	Copies the oldest record and removes it from the log.
+*
+* param[out]	*p_rec: Record.
+*
+* Returns:		1, or 0 if the log is empty.
+*
+* Notes:		Only one task may read the log.
+*
+****************************************************************************/
+
+uint32_t ulDlogRead(DlogRecord_s *p_rec)
+{
+	DlogRecord_s *p_slot = &xDlogRecords[ulDlogTail & (DLOG_RECORD_COUNT - 1U)];
+
+	if (__atomic_load_n(&p_slot->ulSeq, __ATOMIC_ACQUIRE) != (ulDlogTail + 1U))
+	{
+		return 0U;
+	}
+
+	p_rec->usId = p_slot->usId;
+	p_rec->usArgCount = p_slot->usArgCount;
+	p_rec->xTime = p_slot->xTime;
+	p_rec->ulArg[0] = p_slot->ulArg[0];
+	p_rec->ulArg[1] = p_slot->ulArg[1];
+	p_rec->ulArg[2] = p_slot->ulArg[2];
+	p_rec->ulArg[3] = p_slot->ulArg[3];
+
+	__atomic_store_n(&p_slot->ulSeq, ulDlogTail + DLOG_RECORD_COUNT, __ATOMIC_RELEASE);
+	ulDlogTail++;
+
+	return 1U;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulDlogDroppedCount()
+*
+* Description:	Returns the number of records dropped because the log was full.
+*
+****************************************************************************/
+
+uint32_t ulDlogDroppedCount(void)
+{
+	return ulDlogDropped;
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+ * @Title		:	Deferred Binary Log (Header File)
+ * @Filename	:	dlog.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+#ifndef SRC_UTILITIES_DLOG_H_
+#define SRC_UTILITIES_DLOG_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+#include "xtime_l.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* Deferred log. Instead of formatting text on the console UART (which busy-
+ * waits for every character), tasks and ISRs store a compact binary record: a
+ * message ID, up to DLOG_MAX_ARGS 32-bit arguments and a global timer
+ * timestamp. The records are formatted later, by a low priority task or by the
+ * host, using a table of format strings indexed by the message ID.
+ *
+ * Any number of tasks and ISRs may write records (no lock, no critical
+ * section); one consumer reads them. When the log is full, new records are
+ * dropped and counted. */
+#define DLOG_RECORD_COUNT		256U	// Records held (power of two)
+#define DLOG_MAX_ARGS			4U		// Arguments per record
+
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+/* One record: a cache line. */
+typedef struct {
+	volatile uint32_t	ulSeq;						// Slot sequence (internal)
+	uint16_t			usId;						// Message ID
+	uint16_t			usArgCount;					// Arguments used
+	XTime				xTime;						// Global timer when written
+	uint32_t			ulArg[DLOG_MAX_ARGS];
+} __attribute__((aligned(32))) DlogRecord_s;
+
+
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+#define DLOG0(id)				vDlogWrite((id), 0U, 0U, 0U, 0U, 0U)
+#define DLOG1(id, a)			vDlogWrite((id), 1U, (uint32_t)(a), 0U, 0U, 0U)
+#define DLOG2(id, a, b)			vDlogWrite((id), 2U, (uint32_t)(a), (uint32_t)(b), 0U, 0U)
+#define DLOG3(id, a, b, c)		vDlogWrite((id), 3U, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0U)
+#define DLOG4(id, a, b, c, d)	vDlogWrite((id), 4U, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Empties the log. Call once, before any record is written. */
+void vDlogInit(void);
+
+/* Writes a record. May be called from tasks and ISRs. Use the DLOGn() macros. */
+void vDlogWrite(uint16_t id, uint32_t arg_count, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/* Consumer: copies the oldest record to *p_rec and removes it from the log.
+ * Returns 1, or 0 if the log is empty. */
+uint32_t ulDlogRead(DlogRecord_s *p_rec);
+
+/* Records dropped because the log was full. */
+uint32_t ulDlogDroppedCount(void);
+
+
+#endif /* SRC_UTILITIES_DLOG_H_ */
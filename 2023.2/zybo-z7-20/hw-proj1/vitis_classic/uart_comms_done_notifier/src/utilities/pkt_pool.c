@@ -0,0 +1,172 @@
+/******************************************************************************
+ * @Title		:	Packet Buffer Pool
+ * @Filename	:	pkt_pool.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "pkt_pool.h"
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		xPktPoolInit()
+*
+* Description:	Creates the pool's free list and puts all packets on it.
+*
+* param[in]		*p_pool: Pool to initialise.
+* param[in]		*p_packets: Array of packets owned by the pool.
+* param[in]		count: Number of packets in the array.
+*
+* Returns:		XST_SUCCESS, or XST_FAILURE if the free list could not be
+* 				created.
+*
+* Notes:		Call before the scheduler is started.
+*
+****************************************************************************/
+
+int xPktPoolInit(PktPool_s *p_pool, Pkt_s *p_packets, uint32_t count)
+{
+	Pkt_s *p_pkt;
+	uint32_t idx;
+
+	p_pool->ulCount = count;
+	p_pool->xFreeList = xQueueCreate(count, sizeof(Pkt_s *));
+	if (p_pool->xFreeList == NULL)
+	{
+		return XST_FAILURE;
+	}
+
+	for (idx = 0; idx < count; idx++)
+	{
+		p_pkt = &p_packets[idx];
+		p_pkt->ulLength = 0U;
+		p_pkt->ulAction = 0U;
+		(void)xQueueSendToBack(p_pool->xFreeList, &p_pkt, 0);
+	}
+
+	return XST_SUCCESS;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		pxPktPoolGet()
+*
+* Description:	Takes a packet off the free list.
+*
+* param[in]		*p_pool: Pool to take the packet from.
+* param[in]		xTicksToWait: How long to wait for a free packet.
+*
+* Returns:		The packet, or NULL if none became free in time.
+*
+* Notes:		The caller owns the packet until it passes the handle on or
+* 				returns it with vPktPoolPut().
+*
+****************************************************************************/
+
+Pkt_s *pxPktPoolGet(PktPool_s *p_pool, TickType_t xTicksToWait)
+{
+	Pkt_s *p_pkt = NULL;
+
+	if (xQueueReceive(p_pool->xFreeList, &p_pkt, xTicksToWait) != pdPASS)
+	{
+		return NULL;
+	}
+
+	return p_pkt;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vPktPoolPut()
+*
+* Description:	Returns a packet to the free list.
+*
+* param[in]		*p_pool: Pool the packet belongs to.
+* param[in]		*p_pkt: Packet to return.
+*
+* Returns:		None.
+*
+* Notes:		The free list is first in, first out, so the packet that was
+* 				returned longest ago is handed out next.
+*
+****************************************************************************/
+
+void vPktPoolPut(PktPool_s *p_pool, Pkt_s *p_pkt)
+{
+	(void)xQueueSendToBack(p_pool->xFreeList, &p_pkt, 0);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vPktPoolDelete()
+*
+* Description:	Deletes the pool's free list, if it was created.
+*
+* param[in]		*p_pool: Pool to delete.
+*
+* Returns:		None.
+*
+* Notes:		No packet of the pool may be in use, nor any task waiting in
+* 				pxPktPoolGet(). xPktPoolInit() can be called again afterwards.
+*
+****************************************************************************/
+
+void vPktPoolDelete(PktPool_s *p_pool)
+{
+	if (p_pool->xFreeList != NULL)
+	{
+		vQueueDelete(p_pool->xFreeList);
+		p_pool->xFreeList = NULL;
+	}
+	p_pool->ulCount = 0U;
+}
+
+
+
+/****** End functions *****/
+
+/****** End of File **********************************************************/
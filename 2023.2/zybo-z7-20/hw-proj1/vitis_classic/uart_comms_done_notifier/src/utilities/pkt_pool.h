@@ -0,0 +1,102 @@
+/******************************************************************************
+ * @Title		:	Packet Buffer Pool (Header File)
+ * @Filename	:	pkt_pool.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+#ifndef SRC_UTILITIES_PKT_POOL_H_
+#define SRC_UTILITIES_PKT_POOL_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "cmd_handler64B.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+#define PKT_BUFFER_SIZE			CMD_LONG_FRAME_MAX_SIZE		// Largest frame
+#define PKT_HEADROOM			32U							// In front of the frame, for framing overhead
+#define PKT_CACHE_LINE_SIZE		32U							// Cortex-A9 L1/L2 line
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+/* Frame buffer. The buffer starts on a cache line and the packet size is a
+ * whole number of cache lines, so a DMA transfer into one packet never shares
+ * a cache line with another packet. */
+typedef struct {
+	uint8_t		ucBuffer[PKT_HEADROOM + PKT_BUFFER_SIZE];	// Frame data, from PKT_HEADROOM
+	uint32_t	ulOffset;					// Start of the data in ucBuffer
+	uint32_t	ulLength;					// Bytes used from ulOffset
+	uint64_t	ullTimestamp;				// Owner-defined (e.g. time the request arrived)
+	uint32_t	ulAction;					// Owner-defined (e.g. what to do once it has been sent)
+} __attribute__((aligned(PKT_CACHE_LINE_SIZE))) Pkt_s;
+
+
+/* Fixed pool of packets. The free list is a FreeRTOS queue of packet
+ * pointers, so only the 4-byte handle is copied when a packet changes owner,
+ * and a task can block until a packet is free. */
+typedef struct {
+	QueueHandle_t	xFreeList;
+	uint32_t		ulCount;			// Packets in the pool
+} PktPool_s;
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Creates the free list and puts all 'count' packets on it. */
+int xPktPoolInit(PktPool_s *p_pool, Pkt_s *p_packets, uint32_t count);
+
+/* Takes a packet off the free list, waiting up to xTicksToWait. Returns NULL
+ * if none became free. */
+Pkt_s *pxPktPoolGet(PktPool_s *p_pool, TickType_t xTicksToWait);
+
+/* Returns a packet to the free list. */
+void vPktPoolPut(PktPool_s *p_pool, Pkt_s *p_pkt);
+
+/* Deletes the free list (no packet may be in use). */
+void vPktPoolDelete(PktPool_s *p_pool);
+
+
+#endif /* SRC_UTILITIES_PKT_POOL_H_ */
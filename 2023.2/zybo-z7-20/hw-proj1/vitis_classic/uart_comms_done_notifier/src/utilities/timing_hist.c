@@ -0,0 +1,206 @@
+/******************************************************************************
+ * @Title		:	Timing Histograms
+ * @Filename	:	timing_hist.c
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "timing_hist.h"
+
+
+
+
+/*---------------------------------------------------------------------------*/
+/*------------------------------- FUNCTIONS ---------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+
+
+/******************************************************************************
+*
+* Function:		vTimingHistInit()
+*
+* Description:	Empties the histogram and sets its bucket width.
+*
+* param[out]	*p_hist: Histogram.
+* param[in]		bucket_ns: Bucket width in ns (0 is taken as 1). The last
+* 				bucket ends at TIMING_HIST_BUCKETS * bucket_ns.
+*
+****************************************************************************/
+
+void vTimingHistInit(TimingHist_s *p_hist, uint32_t bucket_ns)
+{
+	p_hist->ulBucketNs = (bucket_ns == 0U) ? 1U : bucket_ns;
+	vTimingHistClear(p_hist);
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vTimingHistClear()
+*
+* Description:	Empties the histogram, keeping its bucket width.
+*
+* param[out]	*p_hist: Histogram.
+*
+****************************************************************************/
+
+void vTimingHistClear(TimingHist_s *p_hist)
+{
+	p_hist->ulCount = 0U;
+	p_hist->ulMinNs = 0xFFFFFFFFU;
+	p_hist->ulMaxNs = 0U;
+	p_hist->ullSumNs = 0U;
+	p_hist->ulOverflow = 0U;
+	memset(p_hist->ulBuckets, 0, sizeof(p_hist->ulBuckets));
+}
+
+
+
+/******************************************************************************
+*
+* Function:		vTimingHistAdd()
+*
+* Description:	Adds one sample to the histogram.
+*
+* param[in,out]	*p_hist: Histogram.
+* param[in]		sample_ns: Sample in ns.
+*
+* Notes:		A division and a handful of loads and stores; cheap enough
+* 				to call on every release of a periodic task.
+*
+****************************************************************************/
+
+void vTimingHistAdd(TimingHist_s *p_hist, uint32_t sample_ns)
+{
+	uint32_t bucket = sample_ns / p_hist->ulBucketNs;
+
+	if (bucket < TIMING_HIST_BUCKETS)
+	{
+		p_hist->ulBuckets[bucket]++;
+	}
+	else
+	{
+		p_hist->ulOverflow++;
+	}
+
+	if (sample_ns < p_hist->ulMinNs)
+	{
+		p_hist->ulMinNs = sample_ns;
+	}
+	if (sample_ns > p_hist->ulMaxNs)
+	{
+		p_hist->ulMaxNs = sample_ns;
+	}
+
+	p_hist->ullSumNs += sample_ns;
+	p_hist->ulCount++;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulTimingHistPercentile()
+*
+* Description:	Returns a percentile of the samples.
+*
+* param[in]		*p_hist: Histogram.
+* param[in]		per_mille: Percentile in 1/1000 (e.g. 500 = median,
+* 				999 = 99.9th percentile; above 1000 is taken as 1000).
+*
+* Returns:		The upper edge of the bucket holding the percentile, capped at
+* 				the maximum sample (so 1000 gives the maximum), or the maximum
+* 				if it falls among the overflow samples. 0 if empty.
+*
+****************************************************************************/
+
+uint32_t ulTimingHistPercentile(const TimingHist_s *p_hist, uint32_t per_mille)
+{
+	uint64_t target;
+	uint64_t seen = 0U;
+	uint32_t bucket;
+	uint32_t edge;
+
+	if (p_hist->ulCount == 0U)
+	{
+		return 0U;
+	}
+
+	if (per_mille > 1000U)
+	{
+		per_mille = 1000U;
+	}
+
+	/* Rank of the sample (1..count), rounded up. */
+	target = (((uint64_t)p_hist->ulCount * per_mille) + 999U) / 1000U;
+	if (target == 0U)
+	{
+		target = 1U;
+	}
+
+	for (bucket = 0U; bucket < TIMING_HIST_BUCKETS; bucket++)
+	{
+		seen += p_hist->ulBuckets[bucket];
+		if (seen >= target)
+		{
+			edge = (bucket + 1U) * p_hist->ulBucketNs;
+			return (edge < p_hist->ulMaxNs) ? edge : p_hist->ulMaxNs;
+		}
+	}
+
+	return p_hist->ulMaxNs;
+}
+
+
+
+/******************************************************************************
+*
+* Function:		ulTimingHistMean()
+*
+* Description:	Returns the mean of the samples in ns, or 0 if empty.
+*
+****************************************************************************/
+
+uint32_t ulTimingHistMean(const TimingHist_s *p_hist)
+{
+	if (p_hist->ulCount == 0U)
+	{
+		return 0U;
+	}
+
+	return (uint32_t)(p_hist->ullSumNs / p_hist->ulCount);
+}
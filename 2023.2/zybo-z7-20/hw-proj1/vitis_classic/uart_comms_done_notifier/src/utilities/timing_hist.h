@@ -0,0 +1,107 @@
+/******************************************************************************
+ * @Title		:	Timing Histograms (Header File)
+ * @Filename	:	timing_hist.h
+ * @Author		:	Derek Murray
+ * @Origin Date	:	27/12/2023
+ * @Version		:	1.0.0
+ * @Compiler	:	arm-none-eabi-gcc
+ * @Target		: 	Xilinx Zynq-7000
+ * @Platform	: 	Digilent Zybo-Z7-20
+ *
+ * ------------------------------------------------------------------------
+ *
+ * Copyright (C) 2024  Derek Murray
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+******************************************************************************/
+
+
+
+
+#ifndef SRC_UTILITIES_TIMING_HIST_H_
+#define SRC_UTILITIES_TIMING_HIST_H_
+
+
+/*****************************************************************************/
+/***************************** Include Files *********************************/
+/*****************************************************************************/
+
+#include "xil_types.h"
+#include "xtime_l.h"
+
+
+/*****************************************************************************/
+/************************** Constant Definitions *****************************/
+/*****************************************************************************/
+
+/* Timing histogram. Collects durations (in ns) into TIMING_HIST_BUCKETS
+ * linear buckets of a fixed width, plus an overflow count, and keeps the
+ * count, minimum, maximum and sum, so that the mean and percentiles can be
+ * worked out without storing every sample. A percentile is reported as the
+ * upper edge of the bucket it falls in (never below the true value), capped
+ * at the maximum.
+ *
+ * There is no locking: one task adds samples, and readers must stop that
+ * task while they read or clear (e.g. vTaskSuspendAll). */
+#define TIMING_HIST_BUCKETS		64U
+
+
+
+/*****************************************************************************/
+/******************************* Typedefs ************************************/
+/*****************************************************************************/
+
+typedef struct {
+	uint32_t	ulBucketNs;							// Bucket width
+	uint32_t	ulCount;
+	uint32_t	ulMinNs;
+	uint32_t	ulMaxNs;
+	uint64_t	ullSumNs;
+	uint32_t	ulOverflow;							// Samples beyond the last bucket
+	uint32_t	ulBuckets[TIMING_HIST_BUCKETS];
+} TimingHist_s;
+
+
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+
+/* Global timer counts (XTime_GetTime) to ns. */
+#define TIMING_COUNTS_TO_NS(counts)	((uint32_t)(((uint64_t)(counts) * 1000000000ULL) / COUNTS_PER_SECOND))
+
+
+
+/*****************************************************************************/
+/************************** Function Prototypes ******************************/
+/*****************************************************************************/
+
+/* Empties the histogram and sets its bucket width (ns, at least 1). */
+void vTimingHistInit(TimingHist_s *p_hist, uint32_t bucket_ns);
+
+/* Empties the histogram, keeping its bucket width. */
+void vTimingHistClear(TimingHist_s *p_hist);
+
+/* Adds one sample. */
+void vTimingHistAdd(TimingHist_s *p_hist, uint32_t sample_ns);
+
+/* Returns the per_mille (0..1000) percentile in ns, or 0 if empty. */
+uint32_t ulTimingHistPercentile(const TimingHist_s *p_hist, uint32_t per_mille);
+
+/* Returns the mean in ns, or 0 if empty. */
+uint32_t ulTimingHistMean(const TimingHist_s *p_hist);
+
+
+#endif /* SRC_UTILITIES_TIMING_HIST_H_ */